@@ -0,0 +1,128 @@
+#include "BenchHarness.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool BenchHarness::selected(const std::string& name) const {
+    return config.filter.empty() || name.find(config.filter) != std::string::npos;
+}
+
+const BenchHarness::Result* BenchHarness::run(const std::string& name, const Params& params, size_t items,
+                                              const std::function<void()>& setup,
+                                              const std::function<void()>& body) {
+    if (!selected(name)) return nullptr;
+    
+    using Clock = std::chrono::steady_clock;
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.items = items;
+    
+    for (int i = 0; i < config.warmup; ++i) {
+        setup();
+        body();
+    }
+    const int repetitions = std::max(config.repetitions, 1);
+    result.samplesMs.reserve(repetitions);
+    for (int i = 0; i < repetitions; ++i) {
+        setup();
+        const auto start = Clock::now();
+        body();
+        result.samplesMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    
+    result.medianMs = median(result.samplesMs);
+    result.madMs = medianAbsoluteDeviation(result.samplesMs, result.medianMs);
+    result.minMs = *std::min_element(result.samplesMs.begin(), result.samplesMs.end());
+    
+    results.push_back(std::move(result));
+    printResult(results.back());
+    return &results.back();
+}
+
+double BenchHarness::median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    const double upper = values[middle];
+    if (values.size() % 2 == 1) return upper;
+    const double lower = *std::max_element(values.begin(), values.begin() + middle);
+    return 0.5 * (lower + upper);
+}
+
+double BenchHarness::medianAbsoluteDeviation(const std::vector<double>& values, double center) {
+    std::vector<double> deviations(values.size());
+    std::transform(values.begin(), values.end(), deviations.begin(),
+                   [center](double value) { return std::abs(value - center); });
+    return median(std::move(deviations));
+}
+
+void BenchHarness::printResult(const Result& result) {
+    std::ostringstream label;
+    label << result.name;
+    for (const auto& param : result.params) {
+        label << " " << param.first << "=" << param.second;
+    }
+    
+    std::cout << std::left << std::setw(64) << label.str() << std::right << std::fixed << std::setprecision(3)
+              << std::setw(11) << result.medianMs << " ms  +/-" << std::setw(8) << result.madMs;
+    if (result.items > 0) {
+        std::cout << std::setprecision(2) << std::setw(11) << result.nanosecondsPerItem() << " ns/item";
+    }
+    std::cout << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+static std::string quoted(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+bool BenchHarness::writeJSON(const std::string& path, const Params& context) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    
+    file << std::setprecision(9) << "{\n";
+    for (const auto& entry : context) {
+        file << "  " << quoted(entry.first) << ": " << quoted(entry.second) << ",\n";
+    }
+    file << "  \"warmup\": " << config.warmup << ",\n";
+    file << "  \"repetitions\": " << config.repetitions << ",\n";
+    file << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        file << (i > 0 ? "," : "") << "\n    {\"name\": " << quoted(result.name) << ", \"params\": {";
+        for (size_t p = 0; p < result.params.size(); ++p) {
+            file << (p > 0 ? ", " : "") << quoted(result.params[p].first) << ": " << quoted(result.params[p].second);
+        }
+        file << "}, \"items\": " << result.items
+             << ", \"median_ms\": " << result.medianMs
+             << ", \"mad_ms\": " << result.madMs
+             << ", \"min_ms\": " << result.minMs
+             << ", \"ns_per_item\": " << result.nanosecondsPerItem()
+             << ", \"samples_ms\": [";
+        for (size_t s = 0; s < result.samplesMs.size(); ++s) {
+            file << (s > 0 ? ", " : "") << result.samplesMs[s];
+        }
+        file << "]}";
+    }
+    file << "\n  ]\n}\n";
+    
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark runner: untimed per-repetition setup, warm-up runs,
+// then the median and median absolute deviation (MAD) of the timed runs.
+// Medians and MADs shrug off the odd descheduled repetition that would drag
+// a mean and standard deviation around.
+class BenchHarness {
+public:
+    struct Config {
+        int warmup = 3;
+        int repetitions = 15;
+        std::string filter; // Only run benchmarks whose name contains this
+    };
+    
+    struct Result {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> params;
+        size_t items = 0; // Work per repetition (particles, queries, ...), 0 if not meaningful
+        std::vector<double> samplesMs;
+        double medianMs = 0.0;
+        double madMs = 0.0;
+        double minMs = 0.0;
+        
+        double nanosecondsPerItem() const { return items > 0 ? 1e6 * medianMs / static_cast<double>(items) : 0.0; }
+    };
+    
+    using Params = std::vector<std::pair<std::string, std::string>>;
+
+private:
+    Config config;
+    std::vector<Result> results;
+
+public:
+    explicit BenchHarness(const Config& cfg) : config(cfg) {}
+    
+    const Config& getConfig() const { return config; }
+    bool selected(const std::string& name) const;
+    
+    // Runs `body` warmup + repetitions times, each after an untimed `setup`.
+    // Skipped (returns nullptr) when the name does not match the filter; the
+    // pointer stays valid until the next run
+    const Result* run(const std::string& name, const Params& params, size_t items,
+                      const std::function<void()>& setup, const std::function<void()>& body);
+    const Result* run(const std::string& name, const Params& params, size_t items,
+                      const std::function<void()>& body) {
+        return run(name, params, items, [] {}, body);
+    }
+    
+    const std::vector<Result>& getResults() const { return results; }
+    
+    static double median(std::vector<double> values);
+    static double medianAbsoluteDeviation(const std::vector<double>& values, double center);
+    
+    // One line per result as it completes
+    static void printResult(const Result& result);
+    // `context` becomes top-level members next to the results (threads, build, ...)
+    bool writeJSON(const std::string& path, const Params& context) const;
+};
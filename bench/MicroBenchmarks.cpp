@@ -0,0 +1,188 @@
+#include "MicroBenchmarks.h"
+#include "ParticleStates.h"
+#include "rendering/Renderer.h"
+#include "simulation/ParticleSystem.h"
+#include "simulation/SpatialHash.h"
+#include <string>
+
+namespace {
+
+// Same cell size as ParticleSystem's grid
+constexpr float CELL_SIZE = 0.3f;
+
+// Keeps the optimiser from discarding a benchmark body's result
+volatile size_t sink = 0;
+
+struct NamedState {
+    Distribution distribution;
+    std::string label; // Distribution name, or the preset's
+    std::vector<Particle> particles;
+    std::vector<std::vector<float>> forces;
+    int numTypes = 0;
+};
+
+// Uniform, clustered and preset-derived particle sets of one size
+std::vector<NamedState> makeStates(size_t count, const MicroBenchmarkOptions& options) {
+    std::vector<NamedState> states;
+    ParticleSystem system;
+    for (Distribution distribution : {UNIFORM, CLUSTERED}) {
+        loadState(system, distribution, count, 4, options.seed);
+        states.push_back({distribution, distributionName(distribution), system.getParticles(), system.getForces(), 4});
+    }
+    loadPresetState(system, options.preset, count, options.settleSteps, options.seed);
+    states.push_back({PRESET, options.preset, system.getParticles(), system.getForces(), system.getConfig().numTypes});
+    return states;
+}
+
+void loadNamedState(ParticleSystem& system, const NamedState& state) {
+    system.getConfig().numTypes = state.numTypes;
+    system.getForces() = state.forces;
+    system.setParticles(state.particles);
+}
+
+void benchSpatialHash(BenchHarness& harness, const NamedState& state) {
+    const std::vector<Particle>& particles = state.particles;
+    const BenchHarness::Params params = {{"n", std::to_string(particles.size())}, {"distribution", state.label}};
+    
+    SpatialHash grid(CELL_SIZE);
+    harness.run("spatial_hash/build", params, particles.size(), [&] {
+        grid.clear();
+        for (size_t i = 0; i < particles.size(); ++i) {
+            grid.insert(static_cast<int>(i), particles[i].x, particles[i].y);
+        }
+    });
+    
+    if (!harness.selected("spatial_hash/query")) return;
+    grid.clear();
+    for (size_t i = 0; i < particles.size(); ++i) {
+        grid.insert(static_cast<int>(i), particles[i].x, particles[i].y);
+    }
+    std::vector<int> neighbors;
+    for (float radius : {0.1f, 0.25f}) {
+        BenchHarness::Params queryParams = params;
+        queryParams.push_back({"radius", std::to_string(radius).substr(0, 4)});
+        harness.run("spatial_hash/query", queryParams, particles.size(), [&] {
+            size_t found = 0;
+            for (const Particle& p : particles) {
+                grid.queryInto(p.x, p.y, radius, neighbors);
+                found += neighbors.size();
+            }
+            sink = found;
+        });
+    }
+}
+
+void benchForces(BenchHarness& harness, const NamedState& state, uint32_t seed) {
+    if (!harness.selected("forces")) return;
+    
+    ParticleSystem system;
+    const size_t count = state.particles.size();
+    // Generated states sweep the type count; a preset brings its own
+    std::vector<int> typeCounts = {2, 4, 8};
+    if (state.distribution == PRESET) typeCounts = {state.numTypes};
+    
+    for (int numTypes : typeCounts) {
+        if (state.distribution == PRESET) {
+            loadNamedState(system, state);
+        } else {
+            loadState(system, state.distribution, count, numTypes, seed);
+        }
+        for (float radius : {0.1f, 0.25f}) {
+            system.getConfig().interactionRadius = radius;
+            system.buildSpatialHash();
+            harness.run("forces", {{"n", std::to_string(count)}, {"distribution", state.label},
+                                   {"types", std::to_string(numTypes)}, {"radius", std::to_string(radius).substr(0, 4)}},
+                        count, [&] { system.computeForces(); });
+        }
+    }
+}
+
+void benchIntegrate(BenchHarness& harness, const NamedState& state) {
+    if (!harness.selected("integrate")) return;
+    
+    ParticleSystem system;
+    loadNamedState(system, state);
+    system.buildSpatialHash();
+    system.computeForces(); // Forces stay fixed; only the integration is timed
+    
+    const struct {
+        ParticleSystem::BoundaryMode mode;
+        const char* name;
+    } modes[] = {{ParticleSystem::BOUNCE, "bounce"}, {ParticleSystem::WRAP, "wrap"}, {ParticleSystem::KILL, "kill"}};
+    for (const auto& mode : modes) {
+        system.getConfig().boundaryMode = mode.mode;
+        harness.run("integrate", {{"n", std::to_string(state.particles.size())}, {"distribution", state.label},
+                                  {"boundary", mode.name}},
+                    state.particles.size(),
+                    [&] { system.setParticles(state.particles); },
+                    [&] { system.integrate(1.0f); });
+    }
+}
+
+void benchCompaction(BenchHarness& harness, const NamedState& state) {
+    if (!harness.selected("compaction")) return;
+    
+    ParticleSystem system;
+    loadNamedState(system, state);
+    system.getConfig().boundaryMode = ParticleSystem::KILL;
+    system.buildSpatialHash();
+    system.computeForces();
+    
+    for (int percent : {1, 10}) {
+        // Every (100 / percent)-th particle leaves the world this step
+        std::vector<Particle> leaving = state.particles;
+        const size_t stride = 100 / percent;
+        for (size_t i = 0; i < leaving.size(); i += stride) {
+            leaving[i].x = 1.5f;
+        }
+        harness.run("compaction", {{"n", std::to_string(state.particles.size())}, {"distribution", state.label},
+                                   {"removed_pct", std::to_string(percent)}},
+                    state.particles.size(),
+                    [&] {
+                        system.setParticles(leaving);
+                        system.integrate(1.0f);
+                    },
+                    [&] { system.compactParticles(); });
+    }
+}
+
+void benchRenderPrep(BenchHarness& harness, const NamedState& state) {
+    if (!harness.selected("render")) return;
+    
+    // One real step so the view carries previous positions to blend from
+    ParticleSystem system;
+    loadNamedState(system, state);
+    system.update(1.0f / 60.0f);
+    const ParticleView view = system.getParticleView();
+    const float maxSpeed = system.getConfig().maxSpeed;
+    const BenchHarness::Params params = {{"n", std::to_string(view.count)}, {"distribution", state.label}};
+    
+    std::vector<Renderer::PackedVertex> vertices;
+    for (float alpha : {1.0f, 0.5f}) {
+        BenchHarness::Params packParams = params;
+        packParams.push_back({"alpha", alpha == 1.0f ? "1" : "0.5"});
+        harness.run("render/pack_vertices", packParams, view.count,
+                    [&] { Renderer::packVertices(view, maxSpeed, vertices, alpha); });
+    }
+    
+    std::vector<float> bins;
+    std::vector<uint32_t> scratch;
+    BenchHarness::Params densityParams = params;
+    densityParams.push_back({"resolution", "256"});
+    harness.run("render/bin_density", densityParams, view.count,
+                [&] { sink = static_cast<size_t>(Renderer::binDensity(view, 256, 8, bins, scratch)); });
+}
+
+} // namespace
+
+void runMicroBenchmarks(BenchHarness& harness, const MicroBenchmarkOptions& options) {
+    for (size_t count : options.sizes) {
+        for (const NamedState& state : makeStates(count, options)) {
+            benchSpatialHash(harness, state);
+            benchForces(harness, state, options.seed);
+            benchIntegrate(harness, state);
+            benchCompaction(harness, state);
+            benchRenderPrep(harness, state);
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BenchHarness.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MicroBenchmarkOptions {
+    std::vector<size_t> sizes = {1000, 10000}; // Particle counts
+    std::string preset = "Orbits";             // Source of the preset-derived state
+    int settleSteps = 100;                     // Steps the preset state runs before timing
+    uint32_t seed = 1;
+};
+
+// Spatial hash build and queries, the force kernel, integration per boundary
+// mode, KILL-mode compaction and the renderer's CPU vertex preparation
+void runMicroBenchmarks(BenchHarness& harness, const MicroBenchmarkOptions& options);
@@ -0,0 +1,70 @@
+#include "ParticleStates.h"
+#include <algorithm>
+#include <random>
+
+// Inside the 0.99 boundary, so BOUNCE and KILL leave a fresh state alone
+static constexpr float EXTENT = 0.98f;
+
+const char* distributionName(Distribution distribution) {
+    switch (distribution) {
+        case UNIFORM: return "uniform";
+        case CLUSTERED: return "clustered";
+        case PRESET: return "preset";
+    }
+    return "unknown";
+}
+
+std::vector<Particle> makeParticles(Distribution distribution, size_t count, int numTypes, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-EXTENT, EXTENT);
+    std::uniform_real_distribution<float> velocity(-0.0005f, 0.0005f);
+    
+    // A few tight blobs: most neighbour queries land in crowded cells
+    constexpr int CLUSTERS = 8;
+    std::vector<float> centres(2 * CLUSTERS);
+    for (float& centre : centres) {
+        centre = position(rng) * 0.8f;
+    }
+    std::normal_distribution<float> spread(0.0f, 0.05f);
+    std::uniform_int_distribution<int> cluster(0, CLUSTERS - 1);
+    
+    std::vector<Particle> particles(count);
+    for (size_t i = 0; i < count; ++i) {
+        Particle& p = particles[i];
+        if (distribution == CLUSTERED) {
+            const int c = cluster(rng);
+            p.x = std::clamp(centres[2 * c] + spread(rng), -EXTENT, EXTENT);
+            p.y = std::clamp(centres[2 * c + 1] + spread(rng), -EXTENT, EXTENT);
+        } else {
+            p.x = position(rng);
+            p.y = position(rng);
+        }
+        p.vx = velocity(rng);
+        p.vy = velocity(rng);
+        p.type = static_cast<int>(i % static_cast<size_t>(std::max(numTypes, 1)));
+    }
+    return particles;
+}
+
+void loadState(ParticleSystem& system, Distribution distribution, size_t count, int numTypes, uint32_t seed) {
+    system.getConfig().numTypes = numTypes;
+    system.resizeForceMatrix();
+    
+    std::mt19937 rng(seed ^ 0x9e3779b9u);
+    std::uniform_real_distribution<float> attraction(-1.0f, 1.0f);
+    for (auto& row : system.getForces()) {
+        for (float& force : row) {
+            force = attraction(rng);
+        }
+    }
+    system.setParticles(makeParticles(distribution, count, numTypes, seed));
+}
+
+void loadPresetState(ParticleSystem& system, const std::string& preset, size_t count,
+                     int settleSteps, uint32_t seed) {
+    system.loadPreset(preset);
+    system.setParticles(makeParticles(UNIFORM, count, system.getConfig().numTypes, seed));
+    for (int i = 0; i < settleSteps; ++i) {
+        system.update(1.0f / 60.0f);
+    }
+}
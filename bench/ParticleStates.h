@@ -0,0 +1,27 @@
+#pragma once
+
+#include "simulation/Particle.h"
+#include "simulation/ParticleSystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reproducible particle states for the benchmarks. Everything derives from a
+// seed, so two runs (or two builds) time exactly the same work.
+enum Distribution {
+    UNIFORM,   // Evenly spread over the world
+    CLUSTERED, // Dense gaussian blobs with empty space between them
+    PRESET     // A preset's force matrix, settled from a uniform start
+};
+const char* distributionName(Distribution distribution);
+
+std::vector<Particle> makeParticles(Distribution distribution, size_t count, int numTypes, uint32_t seed);
+
+// Seeded particles and a seeded force matrix with `numTypes` types
+void loadState(ParticleSystem& system, Distribution distribution, size_t count, int numTypes, uint32_t seed);
+
+// The preset's forces and type count, seeded uniform particles, then
+// `settleSteps` fixed steps so the structure the preset forms is present
+void loadPresetState(ParticleSystem& system, const std::string& preset, size_t count,
+                     int settleSteps, uint32_t seed);
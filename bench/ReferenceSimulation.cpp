@@ -0,0 +1,106 @@
+#include "ReferenceSimulation.h"
+#include <cmath>
+
+namespace reference {
+
+// forceProfile in ParticleSystemKernels.inl: repulsion below beta, a triangular
+// attraction/repulsion profile out to the interaction radius
+static double forceProfile(double dist, double attraction) {
+    const double beta = 0.3;
+    if (dist < beta) return attraction * (dist / beta - 1.0);
+    if (dist < 1.0) return attraction * (1.0 - std::abs(2.0 * dist - 1.0 - beta) / (1.0 - beta));
+    return 0.0;
+}
+
+void computeForces(const std::vector<Particle>& particles, const std::vector<std::vector<float>>& matrix,
+                   const ParticleSystem::Config& config, Forces& out) {
+    const size_t n = particles.size();
+    out.x.assign(n, 0.0);
+    out.y.assign(n, 0.0);
+    out.magnitude.assign(n, 0.0);
+    
+    const double radius = config.interactionRadius;
+    const float radiusSq = config.interactionRadius * config.interactionRadius;
+    const bool wrap = config.boundaryMode == ParticleSystem::WRAP;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j) continue;
+            
+            float dx = particles[j].x - particles[i].x;
+            float dy = particles[j].y - particles[i].y;
+            if (wrap) {
+                // Nearest image in the 2-wide world
+                if (dx > 1.0f) dx -= 2.0f;
+                else if (dx < -1.0f) dx += 2.0f;
+                if (dy > 1.0f) dy -= 2.0f;
+                else if (dy < -1.0f) dy += 2.0f;
+            }
+            
+            // Which pairs interact is decided in float like the kernel does: the
+            // force jumps at both cut-offs, so a pair right on one would
+            // otherwise show up as a large, meaningless mismatch
+            const float distSqFloat = dx * dx + dy * dy;
+            if (!(distSqFloat > 0.00001f && distSqFloat < radiusSq)) continue;
+            
+            const double distSq = static_cast<double>(dx) * dx + static_cast<double>(dy) * dy;
+            const double dist = std::sqrt(distSq);
+            const double attraction = matrix[particles[i].type][particles[j].type];
+            const double force = forceProfile(dist / radius, attraction) * config.forceFactor;
+            out.x[i] += dx / dist * force;
+            out.y[i] += dy / dist * force;
+            out.magnitude[i] += std::abs(force);
+        }
+    }
+}
+
+void step(std::vector<Particle>& particles, const std::vector<std::vector<float>>& matrix,
+          const ParticleSystem::Config& config, float dt) {
+    Forces forces;
+    computeForces(particles, matrix, config, forces);
+    
+    const float boundary = 0.99f;
+    const float damping = 0.8f;
+    std::vector<Particle> survivors;
+    survivors.reserve(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        Particle p = particles[i];
+        p.vx = (p.vx + static_cast<float>(forces.x[i]) * dt) * config.friction;
+        p.vy = (p.vy + static_cast<float>(forces.y[i]) * dt) * config.friction;
+        
+        const float speed = std::sqrt(p.vx * p.vx + p.vy * p.vy);
+        if (speed > config.maxSpeed) {
+            p.vx *= config.maxSpeed / speed;
+            p.vy *= config.maxSpeed / speed;
+        }
+        p.x += p.vx * dt;
+        p.y += p.vy * dt;
+        
+        if (config.boundaryMode == ParticleSystem::WRAP) {
+            if (p.x < -boundary) p.x = boundary - 0.001f;
+            else if (p.x > boundary) p.x = -boundary + 0.001f;
+            if (p.y < -boundary) p.y = boundary - 0.001f;
+            else if (p.y > boundary) p.y = -boundary + 0.001f;
+        } else if (config.boundaryMode == ParticleSystem::BOUNCE) {
+            if (p.x < -boundary) {
+                p.x = -boundary;
+                p.vx = std::abs(p.vx) * damping;
+            } else if (p.x > boundary) {
+                p.x = boundary;
+                p.vx = -std::abs(p.vx) * damping;
+            }
+            if (p.y < -boundary) {
+                p.y = -boundary;
+                p.vy = std::abs(p.vy) * damping;
+            } else if (p.y > boundary) {
+                p.y = boundary;
+                p.vy = -std::abs(p.vy) * damping;
+            }
+        } else if (p.x < -boundary || p.x > boundary || p.y < -boundary || p.y > boundary) {
+            continue; // KILL
+        }
+        survivors.push_back(p);
+    }
+    particles.swap(survivors);
+}
+
+} // namespace reference
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "simulation/Particle.h"
+#include "simulation/ParticleSystem.h"
+#include <vector>
+
+// Golden reference for ParticleSystem's physics: every pair visited in index
+// order, no grid, no threads, forces summed in double precision. It is slow
+// on purpose; the fast paths are checked against it, not the other way round.
+// Mouse interaction is not modelled.
+namespace reference {
+
+struct Forces {
+    std::vector<double> x, y;
+    // Sum of |contribution| per particle, the scale rounding error grows with
+    std::vector<double> magnitude;
+};
+
+void computeForces(const std::vector<Particle>& particles, const std::vector<std::vector<float>>& matrix,
+                   const ParticleSystem::Config& config, Forces& out);
+
+// One step: forces, then integrate and remove KILL-mode escapees exactly as
+// ParticleSystem does (dt = 1.0 is one step at 60 steps/s)
+void step(std::vector<Particle>& particles, const std::vector<std::vector<float>>& matrix,
+          const ParticleSystem::Config& config, float dt);
+
+} // namespace reference
@@ -0,0 +1,192 @@
+#include "ScalingBenchmark.h"
+#include "BenchHarness.h"
+#include "ParticleStates.h"
+#include "simulation/ParticleSystem.h"
+#include "util/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const Profiler::Zone PHASE_ZONES[ScalingPoint::PHASE_COUNT] = {
+    Profiler::GRID_BUILD, Profiler::FORCES, Profiler::INTEGRATE};
+
+const char* ScalingPoint::phaseName(Phase phase) {
+    switch (phase) {
+        case GRID_BUILD: return "grid_build";
+        case FORCES: return "forces";
+        case INTEGRATE: return "integrate";
+        case PHASE_COUNT: break;
+    }
+    return "unknown";
+}
+
+static std::vector<int> defaultThreadCounts() {
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+    std::vector<int> counts;
+    for (int t = 1; t <= maxThreads; ++t) {
+        counts.push_back(t);
+    }
+    return counts;
+}
+
+static ScalingPoint measurePoint(const std::string& mode, int threads, size_t count, const ScalingOptions& options) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    ParticleSystem system;
+    loadPresetState(system, options.preset, count, options.settleSteps, options.seed);
+    
+    Profiler& profiler = Profiler::instance();
+    profiler.reset();
+    using Clock = std::chrono::steady_clock;
+    const float fixedDeltaTime = 1.0f / 60.0f;
+    std::vector<double> stepMs;
+    double particleSteps = 0.0;
+    double forceCalculations = 0.0;
+    for (int i = 0; i < options.steps; ++i) {
+        particleSteps += static_cast<double>(system.getParticleCount());
+        const auto start = Clock::now();
+        system.update(fixedDeltaTime);
+        stepMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        forceCalculations += system.getMetrics().forceCalculations;
+        profiler.endFrame();
+    }
+    
+    ScalingPoint point;
+    point.mode = mode;
+    point.threads = threads;
+    point.particles = count;
+    point.medianStepMs = BenchHarness::median(stepMs);
+    for (int phase = 0; phase < ScalingPoint::PHASE_COUNT; ++phase) {
+        ScalingPoint::PhaseStats& stats = point.phases[phase];
+        stats.medianMs = profiler.getStats(PHASE_ZONES[phase]).p50Ms;
+        stats.work = (phase == ScalingPoint::FORCES ? forceCalculations : particleSteps) / options.steps;
+        
+        // Threads outside this team recorded nothing since the reset
+        const std::vector<double> threadMs = profiler.getThreadMs(PHASE_ZONES[phase]);
+        double total = 0.0;
+        double busiest = 0.0;
+        for (double ms : threadMs) {
+            total += ms;
+            busiest = std::max(busiest, ms);
+        }
+        stats.imbalance = total > 0.0 ? busiest / (total / threads) : 0.0;
+    }
+    return point;
+}
+
+// Work per second per thread relative to the first point; for strong scaling
+// this is the usual T1 / (p * Tp)
+static double efficiency(double work, double ms, int threads, double firstWork, double firstMs, int firstThreads) {
+    if (ms <= 0.0 || firstMs <= 0.0 || firstWork <= 0.0) return 0.0;
+    const double throughput = work / ms / threads;
+    const double firstThroughput = firstWork / firstMs / firstThreads;
+    return throughput / firstThroughput;
+}
+
+static void printPoint(const ScalingPoint& point) {
+    std::cout << std::left << std::setw(7) << point.mode << std::right << std::setw(4) << point.threads << "t"
+              << std::setw(9) << point.particles << std::fixed << std::setprecision(3) << std::setw(10)
+              << point.medianStepMs << " ms/step  eff " << std::setprecision(2) << std::setw(5)
+              << point.stepEfficiency;
+    for (int phase = 0; phase < ScalingPoint::PHASE_COUNT; ++phase) {
+        const ScalingPoint::PhaseStats& stats = point.phases[phase];
+        std::cout << "  | " << ScalingPoint::phaseName(static_cast<ScalingPoint::Phase>(phase)) << " "
+                  << std::setprecision(3) << stats.medianMs << " ms eff " << std::setprecision(2)
+                  << stats.efficiency << " imb " << stats.imbalance;
+    }
+    std::cout << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+std::vector<ScalingPoint> runScaling(const ScalingOptions& options) {
+    const std::vector<int> threadCounts = options.threads.empty() ? defaultThreadCounts() : options.threads;
+    Profiler& profiler = Profiler::instance();
+    const bool wasProfiling = profiler.isEnabled();
+    profiler.setEnabled(true); // The phase times and per-thread split come from its zones
+#ifdef _OPENMP
+    const int previousThreads = omp_get_max_threads();
+#endif
+
+    std::vector<ScalingPoint> points;
+    for (const std::string mode : {"strong", "weak"}) {
+        const size_t first = points.size();
+        for (int threads : threadCounts) {
+            const size_t count = mode == "strong" ? options.particles : options.particlesPerThread * threads;
+            points.push_back(measurePoint(mode, threads, count, options));
+            
+            ScalingPoint& point = points.back();
+            const ScalingPoint& base = points[first];
+            point.stepEfficiency = efficiency(static_cast<double>(point.particles), point.medianStepMs, point.threads,
+                                              static_cast<double>(base.particles), base.medianStepMs, base.threads);
+            for (int phase = 0; phase < ScalingPoint::PHASE_COUNT; ++phase) {
+                ScalingPoint::PhaseStats& stats = point.phases[phase];
+                const ScalingPoint::PhaseStats& baseStats = base.phases[phase];
+                stats.efficiency = efficiency(stats.work, stats.medianMs, point.threads,
+                                              baseStats.work, baseStats.medianMs, base.threads);
+            }
+            printPoint(point);
+        }
+    }
+
+#ifdef _OPENMP
+    omp_set_num_threads(previousThreads);
+#endif
+    profiler.reset();
+    profiler.setEnabled(wasProfiling);
+    return points;
+}
+
+bool writeScaling(const std::string& path, const std::vector<ScalingPoint>& points) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    
+    const bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    file << std::setprecision(9);
+    if (json) {
+        file << "{\n  \"points\": [";
+    } else {
+        file << "mode,threads,particles,step_ms,step_efficiency,phase,phase_ms,work,efficiency,imbalance\n";
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+        const ScalingPoint& p = points[i];
+        if (json) {
+            file << (i > 0 ? "," : "") << "\n    {\"mode\": \"" << p.mode << "\", \"threads\": " << p.threads
+                 << ", \"particles\": " << p.particles << ", \"step_ms\": " << p.medianStepMs
+                 << ", \"step_efficiency\": " << p.stepEfficiency << ", \"phases\": {";
+        }
+        for (int phase = 0; phase < ScalingPoint::PHASE_COUNT; ++phase) {
+            const ScalingPoint::PhaseStats& stats = p.phases[phase];
+            const char* name = ScalingPoint::phaseName(static_cast<ScalingPoint::Phase>(phase));
+            if (json) {
+                file << (phase > 0 ? ", " : "") << "\"" << name << "\": {\"ms\": " << stats.medianMs
+                     << ", \"work\": " << stats.work << ", \"efficiency\": " << stats.efficiency
+                     << ", \"imbalance\": " << stats.imbalance << "}";
+            } else {
+                file << p.mode << "," << p.threads << "," << p.particles << "," << p.medianStepMs << ","
+                     << p.stepEfficiency << "," << name << "," << stats.medianMs << "," << stats.work << ","
+                     << stats.efficiency << "," << stats.imbalance << "\n";
+            }
+        }
+        if (json) file << "}}";
+    }
+    if (json) file << "\n  ]\n}\n";
+    
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Thread scaling of a preset's simulation steps. Strong scaling keeps the
+// particle count fixed; weak scaling grows it with the thread count. Each
+// phase gets a parallel efficiency and a load imbalance from the profiler's
+// per-thread zone times.
+struct ScalingOptions {
+    std::string preset = "Orbits";
+    std::vector<int> threads;          // Empty = 1, 2, 3, ... up to the OpenMP maximum
+    size_t particles = 20000;          // Strong scaling problem size
+    size_t particlesPerThread = 5000;  // Weak scaling problem size per thread
+    int steps = 30;                    // Timed steps per point
+    int settleSteps = 10;              // Untimed steps first
+    uint32_t seed = 1;
+};
+
+struct ScalingPoint {
+    enum Phase { GRID_BUILD, FORCES, INTEGRATE, PHASE_COUNT };
+    static const char* phaseName(Phase phase);
+    
+    struct PhaseStats {
+        double medianMs = 0.0;   // Per step, slowest thread
+        double work = 0.0;       // Per step: particles, or force evaluations for FORCES
+        double efficiency = 0.0; // Work per second per thread, relative to the first point
+        double imbalance = 0.0;  // Busiest thread / mean over the team (1 = even, threads = serial)
+    };
+    
+    std::string mode; // "strong" or "weak"
+    int threads = 1;
+    size_t particles = 0;
+    double medianStepMs = 0.0;
+    double stepEfficiency = 0.0;
+    std::array<PhaseStats, PHASE_COUNT> phases;
+};
+
+std::vector<ScalingPoint> runScaling(const ScalingOptions& options);
+
+// *.json writes JSON, anything else CSV (one row per point and phase)
+bool writeScaling(const std::string& path, const std::vector<ScalingPoint>& points);
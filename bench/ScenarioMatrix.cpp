@@ -0,0 +1,218 @@
+#include "ScenarioMatrix.h"
+#include "BenchHarness.h"
+#include "ParticleStates.h"
+#include "simulation/ParticleSystem.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char* const CSV_HEADER =
+    "preset,particles,threads,backend,steps,median_step_ms,mad_step_ms,steps_per_second,final_particles";
+
+std::string ScenarioResult::key() const {
+    return preset + "/" + std::to_string(particles) + "/" + std::to_string(threads) + "/" + backend;
+}
+
+static std::vector<int> defaultThreadCounts() {
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+    std::vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+static ScenarioResult runScenario(const std::string& preset, size_t count, int threads, bool spatialHash,
+                                  const ScenarioOptions& options) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    ParticleSystem system;
+    system.getConfig().useSpatialHash = spatialHash;
+    loadPresetState(system, preset, count, options.settleSteps, options.seed);
+    
+    using Clock = std::chrono::steady_clock;
+    const float fixedDeltaTime = 1.0f / 60.0f;
+    std::vector<double> stepMs;
+    stepMs.reserve(options.steps);
+    for (int i = 0; i < options.steps; ++i) {
+        const auto start = Clock::now();
+        system.update(fixedDeltaTime);
+        stepMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    
+    ScenarioResult result;
+    result.preset = preset;
+    result.particles = count;
+    result.threads = threads;
+    result.backend = spatialHash ? "hash" : "brute";
+    result.steps = options.steps;
+    result.medianStepMs = BenchHarness::median(stepMs);
+    result.madStepMs = BenchHarness::medianAbsoluteDeviation(stepMs, result.medianStepMs);
+    result.finalParticles = system.getParticles().size();
+    return result;
+}
+
+std::vector<ScenarioResult> runScenarios(const ScenarioOptions& options) {
+    const std::vector<std::string> presets = options.presets.empty() ? ParticleSystem::presetNames() : options.presets;
+    const std::vector<int> threadCounts = options.threads.empty() ? defaultThreadCounts() : options.threads;
+#ifdef _OPENMP
+    const int previousThreads = omp_get_max_threads();
+#endif
+
+    std::vector<ScenarioResult> results;
+    for (const std::string& preset : presets) {
+        for (size_t count : options.sizes) {
+            for (int threads : threadCounts) {
+                for (bool spatialHash : {true, false}) {
+                    if (!spatialHash && count > options.bruteForceLimit) continue;
+                    
+                    results.push_back(runScenario(preset, count, threads, spatialHash, options));
+                    const ScenarioResult& result = results.back();
+                    std::ios format(nullptr);
+                    format.copyfmt(std::cout);
+                    std::cout << std::left << std::setw(10) << result.preset << std::right << std::setw(9)
+                              << result.particles << std::setw(4) << result.threads << "t " << std::left
+                              << std::setw(6) << result.backend << std::right << std::fixed << std::setprecision(3)
+                              << std::setw(11) << result.medianStepMs << " ms/step  +/-" << std::setw(8)
+                              << result.madStepMs << std::setprecision(1) << std::setw(10) << result.stepsPerSecond()
+                              << " steps/s" << std::endl;
+                    std::cout.copyfmt(format);
+                }
+            }
+        }
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(previousThreads);
+#endif
+    return results;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool writeScenarios(const std::string& path, const std::vector<ScenarioResult>& results) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    
+    file << std::setprecision(9);
+    if (endsWith(path, ".json")) {
+        file << "{\n  \"scenarios\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const ScenarioResult& r = results[i];
+            file << (i > 0 ? "," : "") << "\n    {\"preset\": \"" << r.preset << "\", \"particles\": " << r.particles
+                 << ", \"threads\": " << r.threads << ", \"backend\": \"" << r.backend << "\", \"steps\": " << r.steps
+                 << ", \"median_step_ms\": " << r.medianStepMs << ", \"mad_step_ms\": " << r.madStepMs
+                 << ", \"steps_per_second\": " << r.stepsPerSecond() << ", \"final_particles\": " << r.finalParticles
+                 << "}";
+        }
+        file << "\n  ]\n}\n";
+    } else {
+        file << CSV_HEADER << "\n";
+        for (const ScenarioResult& r : results) {
+            file << r.preset << "," << r.particles << "," << r.threads << "," << r.backend << "," << r.steps << ","
+                 << r.medianStepMs << "," << r.madStepMs << "," << r.stepsPerSecond() << "," << r.finalParticles
+                 << "\n";
+        }
+    }
+    
+    if (!file) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return true;
+}
+
+bool loadScenarioBaseline(const std::string& path, std::vector<ScenarioResult>& results) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open baseline " << path << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    if (!std::getline(file, line) || line != CSV_HEADER) {
+        std::cerr << "Baseline " << path << " is not a scenario CSV file" << std::endl;
+        return false;
+    }
+    results.clear();
+    int lineNumber = 1;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty()) continue;
+        
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 9) {
+            std::cerr << "Malformed baseline line " << lineNumber << " in " << path << std::endl;
+            return false;
+        }
+        
+        ScenarioResult r;
+        r.preset = fields[0];
+        r.particles = std::strtoull(fields[1].c_str(), nullptr, 10);
+        r.threads = std::atoi(fields[2].c_str());
+        r.backend = fields[3];
+        r.steps = std::atoi(fields[4].c_str());
+        r.medianStepMs = std::atof(fields[5].c_str());
+        r.madStepMs = std::atof(fields[6].c_str());
+        r.finalParticles = std::strtoull(fields[8].c_str(), nullptr, 10);
+        results.push_back(r);
+    }
+    return true;
+}
+
+int compareScenarios(const std::vector<ScenarioResult>& baseline, const std::vector<ScenarioResult>& current,
+                     double thresholdPercent) {
+    std::map<std::string, const ScenarioResult*> byKey;
+    for (const ScenarioResult& r : baseline) {
+        byKey[r.key()] = &r;
+    }
+    
+    std::ios format(nullptr);
+    format.copyfmt(std::cout);
+    std::cout << "\nScenario (preset/particles/threads/backend)   baseline ms   current ms    change" << std::endl;
+    int regressions = 0;
+    int unmatched = 0;
+    for (const ScenarioResult& r : current) {
+        auto it = byKey.find(r.key());
+        if (it == byKey.end() || it->second->medianStepMs <= 0.0) {
+            ++unmatched;
+            continue;
+        }
+        
+        const double change = 100.0 * (r.medianStepMs / it->second->medianStepMs - 1.0);
+        const bool regressed = change > thresholdPercent;
+        regressions += regressed ? 1 : 0;
+        std::cout << std::left << std::setw(44) << r.key() << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(13) << it->second->medianStepMs << std::setw(13) << r.medianStepMs
+                  << std::setprecision(1) << std::showpos << std::setw(9) << change << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+        std::cout.copyfmt(format);
+    }
+    if (unmatched > 0) {
+        std::cout << unmatched << " scenario(s) have no baseline entry" << std::endl;
+    }
+    std::cout << regressions << " regression(s) over " << thresholdPercent << "%" << std::endl;
+    return regressions;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Macro benchmark: whole ParticleSystem::update() steps for every preset x
+// particle count x thread count x spatial backend, so a change that slows
+// one preset down shows up before it ships.
+struct ScenarioOptions {
+    std::vector<std::string> presets;               // Empty = every ParticleSystem::presetNames()
+    std::vector<size_t> sizes = {1000, 10000, 100000};
+    std::vector<int> threads;                       // Empty = 1, 2, 4, ... up to the OpenMP maximum
+    int steps = 30;                                 // Timed steps per scenario
+    int settleSteps = 10;                           // Untimed steps first
+    size_t bruteForceLimit = 20000;                 // Larger counts skip the O(n^2) backend
+    uint32_t seed = 1;
+};
+
+struct ScenarioResult {
+    std::string preset;
+    size_t particles = 0;
+    int threads = 1;
+    std::string backend;     // "hash" or "brute"
+    int steps = 0;
+    double medianStepMs = 0.0;
+    double madStepMs = 0.0;
+    size_t finalParticles = 0; // After the timed steps (KILL presets can lose some)
+    
+    double stepsPerSecond() const { return medianStepMs > 0.0 ? 1000.0 / medianStepMs : 0.0; }
+    // Identity of the scenario, for matching against a baseline
+    std::string key() const;
+};
+
+std::vector<ScenarioResult> runScenarios(const ScenarioOptions& options);
+
+// *.json writes JSON, anything else CSV. Only the CSV form is read back as a baseline
+bool writeScenarios(const std::string& path, const std::vector<ScenarioResult>& results);
+bool loadScenarioBaseline(const std::string& path, std::vector<ScenarioResult>& results);
+
+// Prints a comparison table and returns how many scenarios got slower than
+// the baseline by more than `thresholdPercent` (median time per step)
+int compareScenarios(const std::vector<ScenarioResult>& baseline, const std::vector<ScenarioResult>& current,
+                     double thresholdPercent);
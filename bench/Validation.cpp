@@ -0,0 +1,96 @@
+#include "Validation.h"
+#include "ParticleStates.h"
+#include "ReferenceSimulation.h"
+#include "simulation/ParticleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+struct CaseResult {
+    double forceError = 0.0;    // Worst error as a fraction of its tolerance
+    double positionError = 0.0; // Worst absolute position error after the steps
+    bool countsMatch = true;
+};
+
+CaseResult checkCase(ParticleSystem::BoundaryMode mode, bool spatialHash, size_t count, int numTypes,
+                     const ValidationOptions& options) {
+    ParticleSystem system;
+    loadState(system, UNIFORM, count, numTypes, options.seed);
+    ParticleSystem::Config& config = system.getConfig();
+    config.boundaryMode = mode;
+    config.useSpatialHash = spatialHash;
+    config.timeScale = 1.0f;
+    config.mousePressed = false;
+    
+    CaseResult result;
+    
+    // Forces on the initial state
+    system.buildSpatialHash();
+    system.computeForces();
+    reference::Forces expected;
+    reference::computeForces(system.getParticles(), system.getForces(), config, expected);
+    for (size_t i = 0; i < count; ++i) {
+        const double tolerance = options.forceAbsolute + options.forceRelative * expected.magnitude[i];
+        const double error = std::max(std::abs(system.getForceX()[i] - expected.x[i]),
+                                      std::abs(system.getForceY()[i] - expected.y[i]));
+        result.forceError = std::max(result.forceError, error / tolerance);
+    }
+    
+    // Trajectories. The reference restarts from the system's state every step:
+    // the dynamics are chaotic, so free-running copies drift apart within a
+    // few steps however correct both are
+    for (int s = 0; s < options.steps && result.countsMatch; ++s) {
+        std::vector<Particle> expectedParticles = system.getParticles();
+        reference::step(expectedParticles, system.getForces(), config, 1.0f);
+        system.update(1.0f / 60.0f);
+        
+        const std::vector<Particle>& actual = system.getParticles();
+        result.countsMatch = actual.size() == expectedParticles.size();
+        for (size_t i = 0; result.countsMatch && i < actual.size(); ++i) {
+            result.positionError = std::max({result.positionError,
+                                             static_cast<double>(std::abs(actual[i].x - expectedParticles[i].x)),
+                                             static_cast<double>(std::abs(actual[i].y - expectedParticles[i].y))});
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+bool runValidation(const ValidationOptions& options) {
+    const struct {
+        ParticleSystem::BoundaryMode mode;
+        const char* name;
+    } modes[] = {{ParticleSystem::BOUNCE, "bounce"}, {ParticleSystem::WRAP, "wrap"}, {ParticleSystem::KILL, "kill"}};
+    
+    std::cout << "Backend  Boundary  Particles  Types   Force error/tol   Position error" << std::endl;
+    int failures = 0;
+    int cases = 0;
+    for (bool spatialHash : {true, false}) {
+        for (const auto& mode : modes) {
+            for (size_t count : options.sizes) {
+                for (int numTypes : options.typeCounts) {
+                    const CaseResult result = checkCase(mode.mode, spatialHash, count, numTypes, options);
+                    const bool passed = result.forceError <= 1.0 && result.countsMatch &&
+                                        result.positionError <= options.positionTolerance;
+                    failures += passed ? 0 : 1;
+                    ++cases;
+                    
+                    std::cout << std::left << std::setw(9) << (spatialHash ? "hash" : "brute") << std::setw(10)
+                              << mode.name << std::right << std::setw(9) << count << std::setw(7) << numTypes
+                              << std::scientific << std::setprecision(2) << std::setw(18) << result.forceError
+                              << std::setw(17) << result.positionError;
+                    if (!result.countsMatch) std::cout << "  (different survivors)";
+                    std::cout << (passed ? "  ok" : "  FAIL") << std::endl;
+                    std::cout.unsetf(std::ios::floatfield);
+                }
+            }
+        }
+    }
+    std::cout << (cases - failures) << "/" << cases << " cases within tolerance" << std::endl;
+    return failures == 0;
+}
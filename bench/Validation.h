@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Checks ParticleSystem against the O(n^2) reference for every force backend
+// (spatial hash, brute force; serial and parallel sizes), boundary mode and
+// type count.
+//
+// Tolerances:
+// - forces: |fast - reference| <= forceAbsolute + forceRelative * sum|contributions|,
+//   per component. Float summation in a different order can lose about one
+//   ulp per neighbour relative to the largest terms, hence the relative part
+//   scales with the summed magnitudes rather than the net force.
+// - positions: over `steps` steps, each started from the system's current
+//   state, |fast - reference| <= positionTolerance, and the same particles
+//   must survive KILL mode. Free-running trajectories are not compared; the
+//   dynamics are chaotic, so they part ways whatever the rounding.
+struct ValidationOptions {
+    std::vector<size_t> sizes = {150, 2000}; // Below and above the parallel threshold
+    std::vector<int> typeCounts = {2, 4, 8};
+    int steps = 10;
+    uint32_t seed = 1;
+    double forceAbsolute = 1e-6;
+    double forceRelative = 1e-5;
+    double positionTolerance = 1e-5;
+};
+
+// Prints one line per case; true when every case is within tolerance
+bool runValidation(const ValidationOptions& options);
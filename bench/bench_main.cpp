@@ -0,0 +1,280 @@
+#include "BenchHarness.h"
+#include "MicroBenchmarks.h"
+#include "ScalingBenchmark.h"
+#include "ScenarioMatrix.h"
+#include "Validation.h"
+#include "simulation/ParticleSystem.h"
+#include "util/Profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Microbenchmarks for the simulation and render-preparation kernels, with
+// --scenarios the preset x size x threads x backend matrix of whole steps,
+// with --scaling strong/weak thread scaling per phase, and with --validate
+// a comparison against the O(n^2) reference. Everything runs on
+// reproducible states, so results from two builds can be compared number
+// for number.
+
+struct BenchOptions {
+    BenchHarness::Config harness;
+    MicroBenchmarkOptions micro;
+    ScenarioOptions scenario;
+    ScalingOptions scaling;
+    ValidationOptions validation;
+    std::string jsonPath;
+    
+    // Shared by both modes; unset keeps each mode's default
+    std::vector<size_t> sizes;
+    int settleSteps = -1;
+    int steps = -1;
+    uint32_t seed = 1;
+    
+    bool scenarioMatrix = false;
+    bool threadScaling = false;
+    bool validate = false;
+    std::string outputPath;   // Scenario or scaling results, *.json or CSV
+    std::string baselinePath; // Scenario CSV to compare against
+    double threshold = 5.0;   // Percent slower per step that counts as a regression
+};
+
+static void printUsage() {
+    std::cout << "Usage: particlelife_bench [options]\n"
+              << "Microbenchmarks (default):\n"
+              << "  --filter TEXT      Only run benchmarks whose name contains TEXT (e.g. forces, spatial_hash)\n"
+              << "  --repetitions N    Timed repetitions per benchmark (default 15)\n"
+              << "  --warmup N         Untimed runs before timing (default 3)\n"
+              << "  --preset NAME      Preset for the preset-derived state (default Orbits)\n"
+              << "  --json FILE        Write every result with its samples as JSON\n"
+              << "Scenario matrix:\n"
+              << "  --scenarios        Time whole steps for every preset x size x threads x backend\n"
+              << "  --presets A,B,...  Presets to run (default all)\n"
+              << "  --threads A,B,...  OpenMP thread counts (default 1, 2, 4, ... up to the maximum)\n"
+              << "  --steps N          Timed steps per scenario (default 30)\n"
+              << "  --brute-limit N    Largest count also run without the spatial hash (default 20000)\n"
+              << "  --output FILE      Write the results as CSV, or JSON for *.json\n"
+              << "  --baseline FILE    Compare with an earlier CSV; exits with 2 on a regression\n"
+              << "  --threshold PCT    Slowdown per step that counts as a regression (default 5)\n"
+              << "Thread scaling:\n"
+              << "  --scaling          Strong and weak scaling of --preset over --threads (default 1, 2, 3, ...)\n"
+              << "  --particles N      Strong scaling particle count (default 20000)\n"
+              << "  --per-thread N     Weak scaling particles per thread (default 5000)\n"
+              << "  --steps, --output  As for the scenario matrix\n"
+              << "Validation:\n"
+              << "  --validate         Compare forces and K-step trajectories with the O(n^2) reference for every\n"
+              << "                     backend, boundary mode and type count; exits with 1 on a mismatch\n"
+              << "  --steps N          Steps compared (default 10); --sizes defaults to 150,2000\n"
+              << "All modes:\n"
+              << "  --sizes A,B,...    Particle counts (default 1000,10000; scenarios 1000,10000,100000)\n"
+              << "  --settle N         Untimed steps of each preset state (default 100; scenarios 10)\n"
+              << "  --seed N           Seed for the generated states (default 1)\n";
+}
+
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Comma-separated positive integers
+template <typename T>
+static bool parseCounts(const std::string& text, std::vector<T>& counts) {
+    counts.clear();
+    for (const std::string& item : splitList(text)) {
+        const long long count = std::atoll(item.c_str());
+        if (count <= 0) return false;
+        counts.push_back(static_cast<T>(count));
+    }
+    return !counts.empty();
+}
+
+// A whole decimal number that fits in uint32_t; strtoul would take "abc" as 0
+// and wrap larger values
+static bool parseSeed(const char* text, uint32_t& seed) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0' || value > UINT32_MAX) return false;
+    seed = static_cast<uint32_t>(value);
+    return true;
+}
+
+static bool isPreset(const std::string& name) {
+    const std::vector<std::string>& known = ParticleSystem::presetNames();
+    if (std::find(known.begin(), known.end(), name) != known.end()) return true;
+    std::cerr << "Unknown preset: " << name << std::endl;
+    return false;
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return false;
+        }
+        if (arg == "--scenarios") {
+            options.scenarioMatrix = true;
+            continue;
+        }
+        if (arg == "--scaling") {
+            options.threadScaling = true;
+            continue;
+        }
+        if (arg == "--validate") {
+            options.validate = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--filter") options.harness.filter = value;
+        else if (arg == "--repetitions") options.harness.repetitions = std::atoi(value);
+        else if (arg == "--warmup") options.harness.warmup = std::atoi(value);
+        else if (arg == "--preset") {
+            options.micro.preset = value;
+            if (!isPreset(value)) return false;
+        }
+        else if (arg == "--particles") options.scaling.particles = std::strtoull(value, nullptr, 10);
+        else if (arg == "--per-thread") options.scaling.particlesPerThread = std::strtoull(value, nullptr, 10);
+        else if (arg == "--settle") options.settleSteps = std::atoi(value);
+        else if (arg == "--seed") {
+            if (!parseSeed(value, options.seed)) {
+                std::cerr << "Invalid --seed: " << value << " (expected 0 to 4294967295)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--json") options.jsonPath = value;
+        else if (arg == "--presets") {
+            options.scenario.presets = splitList(value);
+            for (const std::string& preset : options.scenario.presets) {
+                if (!isPreset(preset)) return false;
+            }
+        }
+        else if (arg == "--steps") options.steps = std::atoi(value);
+        else if (arg == "--brute-limit") options.scenario.bruteForceLimit = std::strtoull(value, nullptr, 10);
+        else if (arg == "--output") options.outputPath = value;
+        else if (arg == "--baseline") options.baselinePath = value;
+        else if (arg == "--threshold") options.threshold = std::atof(value);
+        else if (arg == "--sizes" || arg == "--threads") {
+            const bool valid = arg == "--sizes" ? parseCounts(value, options.sizes)
+                                                : parseCounts(value, options.scenario.threads);
+            if (!valid) {
+                std::cerr << "Invalid " << arg << ": " << value << std::endl;
+                return false;
+            }
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return false;
+        }
+    }
+    
+    if (!options.sizes.empty()) {
+        options.micro.sizes = options.sizes;
+        options.scenario.sizes = options.sizes;
+        options.validation.sizes = options.sizes;
+    }
+    if (options.steps > 0) {
+        options.scenario.steps = options.steps;
+        options.scaling.steps = options.steps;
+        options.validation.steps = options.steps;
+    }
+    if (options.settleSteps >= 0) {
+        options.micro.settleSteps = options.settleSteps;
+        options.scenario.settleSteps = options.settleSteps;
+    }
+    options.micro.seed = options.seed;
+    options.scenario.seed = options.seed;
+    options.validation.seed = options.seed;
+    
+    options.scaling.preset = options.micro.preset;
+    options.scaling.threads = options.scenario.threads;
+    if (options.settleSteps >= 0) options.scaling.settleSteps = options.settleSteps;
+    options.scaling.seed = options.seed;
+    return options.harness.repetitions > 0 && options.harness.warmup >= 0 && options.steps != 0 &&
+           options.scaling.particles > 0 && options.scaling.particlesPerThread > 0;
+}
+
+static int runScenarioMatrix(const BenchOptions& options) {
+    const std::vector<ScenarioResult> results = runScenarios(options.scenario);
+    if (!options.outputPath.empty() && !writeScenarios(options.outputPath, results)) {
+        return 1;
+    }
+    if (options.baselinePath.empty()) return 0;
+    
+    std::vector<ScenarioResult> baseline;
+    if (!loadScenarioBaseline(options.baselinePath, baseline)) {
+        return 1;
+    }
+    return compareScenarios(baseline, results, options.threshold) > 0 ? 2 : 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    
+    // Zone recording costs a few ns per scope; keep it out of the numbers
+    Profiler::instance().setEnabled(false);
+    // Every case builds fresh systems; their status lines would bury the results
+    ParticleSystem::setLogging(false);
+    
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    if (options.validate) {
+        std::cout << "particlelife_bench: validation against the O(n^2) reference, " << options.validation.steps
+                  << " steps" << std::endl;
+        return runValidation(options.validation) ? 0 : 1;
+    }
+    if (options.threadScaling) {
+        std::cout << "particlelife_bench: thread scaling of " << options.scaling.preset << ", "
+                  << options.scaling.steps << " timed steps per point (eff = efficiency, imb = load imbalance)"
+                  << std::endl;
+        const std::vector<ScalingPoint> points = runScaling(options.scaling);
+        return options.outputPath.empty() || writeScaling(options.outputPath, points) ? 0 : 1;
+    }
+    if (options.scenarioMatrix) {
+        std::cout << "particlelife_bench: scenario matrix, " << options.scenario.steps
+                  << " timed steps each (median +/- MAD per step)" << std::endl;
+        return runScenarioMatrix(options);
+    }
+    std::cout << "particlelife_bench: " << threads << " thread(s), " << options.harness.warmup << " warm-up + "
+              << options.harness.repetitions << " timed repetitions (median +/- MAD)" << std::endl;
+    
+    BenchHarness harness(options.harness);
+    runMicroBenchmarks(harness, options.micro);
+    
+    if (!options.jsonPath.empty()) {
+        const BenchHarness::Params context = {
+            {"threads", std::to_string(threads)},
+            {"seed", std::to_string(options.micro.seed)},
+            {"preset", options.micro.preset},
+            {"settle_steps", std::to_string(options.micro.settleSteps)},
+        };
+        if (!harness.writeJSON(options.jsonPath, context)) {
+            return 1;
+        }
+    }
+    return 0;
+}
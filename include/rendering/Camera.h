@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+
+// 2D view onto the [-1, 1] simulation world. Screen positions are normalised
+// device coordinates of the simulation viewport; zoom = 1 shows the whole world.
+class Camera {
+public:
+    static constexpr float MIN_ZOOM = 0.1f;
+    static constexpr float MAX_ZOOM = 64.0f;
+
+private:
+    glm::vec2 center;
+    float zoom;
+
+public:
+    Camera() : center(0.0f), zoom(1.0f) {}
+
+    void reset() {
+        center = glm::vec2(0.0f);
+        zoom = 1.0f;
+    }
+
+    const glm::vec2& getCenter() const { return center; }
+    float getZoom() const { return zoom; }
+    void setCenter(const glm::vec2& c) { center = c; }
+    void setZoom(float z) { zoom = std::clamp(z, MIN_ZOOM, MAX_ZOOM); }
+
+    // World -> clip space
+    glm::mat4 getViewMatrix() const {
+        glm::mat4 view(1.0f);
+        view[0][0] = zoom;
+        view[1][1] = zoom;
+        view[3][0] = -center.x * zoom;
+        view[3][1] = -center.y * zoom;
+        return view;
+    }
+
+    // Clip -> world space
+    glm::mat4 getInverseViewMatrix() const {
+        glm::mat4 inverse(1.0f);
+        inverse[0][0] = 1.0f / zoom;
+        inverse[1][1] = 1.0f / zoom;
+        inverse[3][0] = center.x;
+        inverse[3][1] = center.y;
+        return inverse;
+    }
+
+    glm::vec2 screenToWorld(const glm::vec2& ndc) const { return center + ndc / zoom; }
+    glm::vec2 worldToScreen(const glm::vec2& world) const { return (world - center) * zoom; }
+
+    // Zoom by `factor`, keeping the world point under `ndc` fixed on screen
+    void zoomAt(const glm::vec2& ndc, float factor) {
+        const glm::vec2 anchor = screenToWorld(ndc);
+        setZoom(zoom * factor);
+        center = anchor - ndc / zoom;
+    }
+
+    // Move the view by a screen-space delta (drag direction)
+    void pan(const glm::vec2& ndcDelta) { center -= ndcDelta / zoom; }
+
+    // World-space rectangle covered by the viewport
+    void getVisibleBounds(glm::vec2& minCorner, glm::vec2& maxCorner) const {
+        minCorner = center - glm::vec2(1.0f / zoom);
+        maxCorner = center + glm::vec2(1.0f / zoom);
+    }
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "util/WorkerPool.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Asynchronous framebuffer readback through a ring of pixel-pack buffers.
+// capture() only queues a DMA into a PBO; the buffer is mapped one or more
+// frames later by poll(), and the pixels are handed to a worker pool so
+// flipping and encoding never run on the render thread.
+class FrameCapture {
+public:
+    struct Frame {
+        int width = 0;
+        int height = 0;
+        uint64_t index = 0;             // Monotonic capture number
+        bool topDown = false;           // GL readbacks are bottom-up
+        std::vector<unsigned char> rgba; // Tightly packed RGBA8 rows
+        
+        bool empty() const { return width <= 0 || height <= 0; }
+    };
+    
+    // Runs on a worker thread once the pixels are available. Every capture()
+    // calls its handler exactly once; a frame that could not be read back
+    // (empty viewport, failed map) arrives empty, width == height == 0
+    using FrameHandler = std::function<void(Frame&)>;
+
+private:
+    struct Slot {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        uint64_t index = 0;
+        FrameHandler handler;
+    };
+    
+    std::vector<Slot> slots;
+    size_t nextSlot;
+    uint64_t captureCount;
+    WorkerPool workers;
+    
+    void retire(Slot& slot);
+    void dispatch(std::shared_ptr<Frame> frame, FrameHandler handler);
+
+public:
+    explicit FrameCapture(int ringSize = 3, int workerThreads = 2, size_t maxQueuedFrames = 0);
+    ~FrameCapture();
+    
+    bool initialize();
+    void cleanup();
+    
+    // Queue an async readback of the current read buffer (call before swap).
+    // Blocks only if every ring slot is still in flight.
+    void capture(int x, int y, int width, int height, FrameHandler handler);
+    
+    // Map readbacks whose fences have signalled and dispatch them
+    void poll();
+    
+    // Retire all in-flight readbacks and wait for the workers to finish
+    void flush();
+    
+    size_t inFlight() const;
+    size_t queuedFrames() const { return workers.queued(); }
+    
+    // Helpers for handlers: flip to top-down RGB and write a PNG
+    static void toTopDownRGB(const Frame& frame, std::vector<unsigned char>& rgb);
+    static bool writePNG(const Frame& frame, const std::string& filename);
+};
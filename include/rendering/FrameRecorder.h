@@ -0,0 +1,74 @@
+#pragma once
+
+#include "rendering/FrameCapture.h"
+#include "util/WorkerPool.h"
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Streams every Nth rendered frame to disk as a PNG sequence or a single
+// raw Y4M file (ffmpeg -i run.y4m ...). Frames go through a bounded queue
+// drained by encoder threads; when encoding falls behind, submit() blocks
+// the caller so the simulation slows down instead of memory growing.
+// Y4M frames finished out of order wait in a reorder buffer capped at
+// maxReorderFrames; past the cap the missing frames are given up on.
+class FrameRecorder {
+public:
+    enum Format { PNG_SEQUENCE, Y4M };
+    
+    struct Config {
+        Format format = Y4M;
+        std::string path = "recording.y4m"; // Directory for PNG sequences
+        int captureEvery = 1;               // Record every Nth frame
+        int frameRate = 60;                 // Written to the Y4M header
+        int encoderThreads = 2;
+        size_t maxQueuedFrames = 8;
+        size_t maxReorderFrames = 32; // Encoded Y4M frames waiting for an earlier one
+    };
+
+private:
+    Config config;
+    WorkerPool encoders;
+    
+    bool recording;
+    uint64_t frameCounter;   // Frames seen by beginFrame()
+    uint64_t nextSequence;   // Sequence number of the next recorded frame
+    
+    // Y4M output is written strictly in sequence order
+    std::mutex writeMutex;
+    FILE* y4mFile;
+    int y4mWidth, y4mHeight;
+    uint64_t nextToWrite;
+    std::map<uint64_t, std::vector<unsigned char>> pendingWrites; // Empty = skipped
+    uint64_t framesWritten;
+    uint64_t framesDropped;
+    
+    void encodePNG(uint64_t sequence, const FrameCapture::Frame& frame);
+    void encodeY4M(uint64_t sequence, const FrameCapture::Frame& frame);
+    void writeInOrder(uint64_t sequence, int width, int height, std::vector<unsigned char>&& yuv);
+
+public:
+    explicit FrameRecorder(const Config& config);
+    ~FrameRecorder();
+    
+    bool start();
+    void stop(); // Drains the queue and closes the output
+    bool isRecording() const { return recording; }
+    
+    // Call once per rendered frame. Returns true (and a sequence number) when
+    // this frame should be recorded.
+    bool beginFrame(uint64_t& sequence);
+    
+    // Hand over a captured frame; blocks while maxQueuedFrames are pending.
+    // May be called from any thread and out of order. Every sequence from
+    // beginFrame() must be submitted once; an empty frame marks it skipped.
+    void submit(uint64_t sequence, FrameCapture::Frame&& frame);
+    
+    const Config& getConfig() const { return config; }
+    uint64_t getFramesWritten();
+    uint64_t getFramesDropped();
+    size_t getQueuedFrames() const { return encoders.queued(); }
+};
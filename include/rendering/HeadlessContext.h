@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+
+// Offscreen OpenGL 3.3 core context for runs without a window.
+// Uses EGL (surfaceless where available, otherwise a 1x1 pbuffer) and renders
+// into a framebuffer object, so it works on GPU-less Mesa llvmpipe servers.
+class HeadlessContext {
+private:
+    // EGL handles kept opaque so callers don't need the EGL headers
+    void* display;
+    void* context;
+    void* surface;
+    
+    GLuint fbo, colorBuffer;
+    int width, height;
+
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+    
+    bool initialize(int width, int height);
+    void cleanup();
+    
+    // Bind the offscreen framebuffer as the render target
+    void bindFramebuffer() const;
+    
+    // Read the framebuffer as tightly packed, top-down RGBA8 rows
+    void readPixels(std::vector<unsigned char>& rgba) const;
+    
+    // EGL proc loader, for entry points outside the generated GL loader
+    static GLADloadproc getProcLoader();
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "rendering/Renderer.h"
+#include "util/FramePacer.h"
+#include <string>
+#include <vector>
+
+// Keeps the frame time under a budget by trading quality for speed.
+// Per-phase times are averaged over short windows. A window over budget
+// lowers one level on the ladder of the most expensive phase; a sustained
+// run of windows well under budget undoes the most recent change. A cooldown
+// after every change lets its effect show up before the next decision.
+// Every decision is logged to stdout.
+class QualityGovernor {
+public:
+    struct Config {
+        bool enabled = false;
+        float budgetMs = 16.7f;
+        float degradeRatio = 1.05f; // Window average above budget * ratio lowers quality
+        float restoreRatio = 0.6f;  // Below budget * ratio counts towards restoring
+        int restoreWindows = 6;     // Consecutive good windows before restoring a level
+        float windowSeconds = 0.5f;
+        float cooldownSeconds = 1.0f;
+    };
+    
+    // Render ladder, cheapest visual loss first
+    static constexpr int MAX_RENDER_LEVEL = 4; // Half-res trails, 1/2, 1/4 of particles, density
+    // Simulation ladder: fixed step rate halved per level (fixed-step pacing modes only)
+    static constexpr int MAX_SIM_LEVEL = 2;
+    static constexpr float MIN_STEP_RATE = 15.0f;
+
+private:
+    enum Ladder { RENDER_LADDER, SIM_LADDER };
+    struct Change {
+        Ladder ladder;
+        int previousLevel;
+    };
+    
+    Config config;
+    int renderLevel;
+    int simLevel;
+    std::vector<Change> history; // Undone last-first
+    
+    // User settings captured when a ladder first leaves level 0
+    bool baseHalfResolutionTrails;
+    int baseRenderStride;
+    bool baseDensityMode;
+    float baseStepRate;
+    
+    // Current measurement window
+    double windowStart;
+    double cooldownUntil;
+    int frames;
+    double updateSum, renderSum, uiSum;
+    int goodWindows;
+    int restoreBackoff;   // Multiplies restoreWindows after a restore had to be undone
+    double lastRestoreTime;
+    bool started;
+    bool atFloorLogged;
+    bool trailsEnabled;
+    std::string lastDecision;
+    
+    void evaluate(double now, Renderer::Config& render, FramePacer::Config& pacing);
+    int nextRenderLevel() const; // Skips levels that would change nothing; -1 at the floor
+    bool canLowerSim(const FramePacer::Config& pacing) const;
+    void renderSettings(int level, bool& halfResolutionTrails, int& stride, bool& density) const;
+    void applyRenderLevel(Renderer::Config& render) const;
+    void applySimLevel(FramePacer::Config& pacing) const;
+    std::string describe(Ladder ladder) const;
+
+public:
+    QualityGovernor();
+    
+    Config& getConfig() { return config; }
+    const Config& getConfig() const { return config; }
+    
+    // Call once per rendered frame with the milliseconds spent in each phase.
+    // `now` is in seconds from any monotonic clock
+    void recordFrame(double now, float updateMs, float renderMs, float uiMs,
+                     Renderer::Config& render, FramePacer::Config& pacing);
+    
+    // Undo every change, e.g. when the governor is switched off
+    void restoreAll(Renderer::Config& render, FramePacer::Config& pacing);
+    
+    int getRenderLevel() const { return renderLevel; }
+    int getSimLevel() const { return simLevel; }
+    const std::string& getLastDecision() const { return lastDecision; }
+};
@@ -1,17 +1,25 @@
 #pragma once
 
 #include "simulation/Particle.h"
+#include "simulation/ParticleView.h"
+#include "rendering/Camera.h"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 class ShaderManager; // Forward declaration
+class SpatialHash;
+class FileWatcher;
 
 class Renderer {
 public:
     struct Config {
         bool enableTrails = false;
         float trailIntensity = 0.95f;
+        bool halfResolutionTrails = false; // Accumulate trails at half size
         bool enableGlow = true;
         float particleSize = 8.0f;
         bool colorBySpeed = false;
@@ -31,16 +39,134 @@ public:
         bool showCenter = false;
         bool useTypeColors = true;
         bool useVelocityColors = false;
+        
+        // Upload path: false binds the simulation arrays as-is (no CPU loop),
+        // true quantises into PackedVertex first (2.5x less upload bandwidth)
+        bool compactVertices = false;
+        
+        // Density mode: particles are binned per type into a low-resolution
+        // histogram and tone-mapped in one full-screen draw, so the GPU cost
+        // no longer depends on the particle count
+        bool densityMode = false;
+        int densityResolution = 256;
+        float densityExposure = 0.5f; // Relative to the mean particles per cell
+        
+        // Camera: when zoomed in, only particles in simulation grid cells
+        // overlapping the view are uploaded. Zoomed out below lodZoom, the
+        // per-cell density aggregate is drawn instead of individual points
+        bool cullToView = true;
+        float lodZoom = 0.5f;
+        
+        // Sprite path: false draws GL_POINTS (size capped by the driver),
+        // true draws one instanced quad per particle
+        bool instancedQuads = false;
+        
+        // Velocity vectors: world-space line length at maxSpeed
+        float velocityVectorLength = 0.05f;
+        
+        // Draw every Nth particle (lowered by the quality governor)
+        int renderStride = 1;
     };
+    
+    // Compact 8-byte vertex: snorm16 position, palette index and quantised velocity.
+    // Colours are resolved in the vertex shader from the palette/gradient uniforms.
+    struct PackedVertex {
+        int16_t x, y;
+        uint8_t type;
+        int8_t vx, vy;   // v / maxSpeed mapped to [-127, 127]
+        uint8_t padding;
+    };
+    static_assert(sizeof(PackedVertex) == 8, "PackedVertex must stay 8 bytes");
 
 private:
     GLuint VAO, VBO;
+    
+    // Direct path: one VAO, up to one buffer per attribute stream
+    // (position, type, velocity, previous position)
+    GLuint directVAO;
+    GLuint streamVBOs[4];
     std::unique_ptr<ShaderManager> ownedShaderManager;
     ShaderManager* shaderManager;
     Config config;
     
     // Predefined color palette
     std::vector<glm::vec3> colors;
+    
+    // Speed gradient stops (blue -> cyan -> green -> yellow -> red)
+    std::vector<glm::vec3> speedGradient;
+    
+    std::vector<PackedVertex> vertexData;
+    
+    std::unique_ptr<ShaderManager> quadShader;   // Instanced sprite program
+    std::unique_ptr<ShaderManager> vectorShader; // Instanced velocity lines
+    
+    // Trail accumulation: ping-pong float targets faded by a full-screen pass
+    std::unique_ptr<ShaderManager> screenShader;
+    GLuint screenVAO;
+    GLuint trailFBOs[2];
+    GLuint trailTextures[2];
+    int trailWidth, trailHeight;
+    int trailIndex;           // Target written this frame
+    bool trailsActive;        // Frame is being drawn into the trail buffers
+    bool trailsValid;         // Buffers hold a previous frame worth fading
+    GLint targetFramebuffer;  // Framebuffer/viewport to composite into
+    GLint targetViewport[4];
+    bool targetScissor;
+    
+    // Density mode: per-type histogram layers in a texture array
+    std::unique_ptr<ShaderManager> densityShader;
+    GLuint densityTexture;
+    int densityResolution, densityLayers; // Current texture allocation
+    std::vector<float> densityBins;
+    std::vector<uint32_t> densityScratch;
+    
+    // Mirrors the std140 RenderParams block in the shaders
+    struct RenderParams {
+        glm::mat4 view;
+        glm::vec4 palette[8];
+        glm::vec4 speedGradient[5];
+        float pointSize;
+        float minSize;
+        float maxSize;
+        float sizeScale;
+        float speedScale;
+        float time;
+        float vectorLength;
+        int32_t paletteSize;
+        glm::vec2 viewportSize;
+        int32_t colorBySpeed;
+        int32_t sizeBySpeed;
+        int32_t enableGlow;
+        float interpolation;
+        int32_t padding[2];
+    };
+    static_assert(sizeof(RenderParams) == 336, "RenderParams must match the std140 layout");
+    static constexpr GLuint RENDER_PARAMS_BINDING = 0;
+    
+    GLuint renderParamsUBO;
+    RenderParams renderParams;
+    float time;
+    
+    Camera camera;
+    std::vector<int> visibleIndices;
+    std::vector<Particle> visibleParticles;
+    
+    // GLSL sources, optionally watched for edits
+    std::string shaderDirectory;
+    std::unique_ptr<FileWatcher> shaderWatcher;
+    
+    bool loadShaders();
+    bool ensureTrailTargets(int width, int height);
+    void destroyTrailTargets();
+    void beginTrailFrame();
+    
+    void uploadPalette();
+    void updateRenderParams(float interpolation);
+    void uploadPacked(const ParticleView& particles, float alpha);
+    void uploadStreams(const ParticleView& particles);
+    void renderDensity(const ParticleView& particles);
+    void renderPoints(const ParticleView& particles, float alpha);
+    void gatherVisible(const ParticleView& particles, const SpatialHash& cells, float alpha);
 
 public:
     Renderer();
@@ -50,16 +176,53 @@ public:
     bool initialize();
     void cleanup();
     
+    // Shaders are read from `directory` at initialize(); set it beforehand
+    void setShaderDirectory(const std::string& directory) { shaderDirectory = directory; }
+    const std::string& getShaderDirectory() const { return shaderDirectory; }
+    // The source tree's resources/shaders when it exists, else the copy next
+    // to the executable, else resources/shaders relative to the working directory
+    static std::string defaultShaderDirectory();
+    
+    // Watch the shader directory and rebuild the programs when a file
+    // changes. They are replaced as a set: if any fails to build, all keep
+    // their previous version
+    void setShaderHotReload(bool enabled);
+    bool isShaderHotReloadEnabled() const { return shaderWatcher != nullptr; }
+    bool reloadShaders();
+    
     Config& getConfig() { return config; }
     const Config& getConfig() const { return config; }
     
+    // setupFrame() renders into the framebuffer/viewport bound at call time.
+    // present() composites any offscreen passes (trails) back into it.
     void setupFrame();
-    void renderParticles(const std::vector<Particle>& particles);
+    // `cells` (optional) is the simulation grid used to cull to the camera view.
+    // `alpha` blends from the view's previous positions (if any) to the
+    // current ones, for rendering between fixed simulation steps
+    void renderParticles(const ParticleView& particles, const SpatialHash* cells = nullptr,
+                         float alpha = 1.0f);
     void present();
     
+    Camera& getCamera() { return camera; }
+    const Camera& getCamera() const { return camera; }
+    
+    // Quantise particles into the compact vertex format, positions blended
+    // by `alpha` from the previous state when the view has one (no GL calls)
+    static void packVertices(const ParticleView& particles, float maxSpeed,
+                             std::vector<PackedVertex>& out, float alpha = 1.0f);
+    
+    // Count particles into `resolution` x `resolution` grids over [-1, 1]^2,
+    // one layer per type (type % maxLayers), row 0 at y = -1. `scratch` holds
+    // the per-chunk histograms. Returns the number of layers written (no GL calls)
+    static int binDensity(const ParticleView& particles, int resolution, int maxLayers,
+                          std::vector<float>& out, std::vector<uint32_t>& scratch);
+    
     // Viewport management
     void setViewport(int width, int height);
     
     // Color utilities
     const std::vector<glm::vec3>& getColors() const { return colors; }
+    static std::vector<glm::vec3> defaultPalette();
+    static std::vector<glm::vec3> defaultSpeedGradient();
+    static glm::vec3 backgroundColor() { return glm::vec3(0.05f, 0.05f, 0.08f); }
 };
\ No newline at end of file
@@ -1,29 +1,67 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
 
 class ShaderManager {
 private:
     GLuint shaderProgram;
     
+    // Active uniform locations, filled once after linking. Array uniforms are
+    // stored under both "name" and "name[0]"
+    std::unordered_map<std::string, GLint> uniformLocations;
+    
     GLuint compileShader(const std::string& source, GLenum type);
-    std::string loadShaderFromFile(const std::string& filepath);
+    void cacheUniformLocations();
+    
+    // Program binary cache
+    static std::string binaryCachePath(const std::string& vertexSource, const std::string& fragmentSource);
+    static GLuint loadProgramBinary(const std::string& path);
+    static void saveProgramBinary(GLuint program, const std::string& path);
+    
+    static constexpr int MAX_INCLUDE_DEPTH = 8;
+    std::string loadShaderFromFile(const std::string& filepath, int depth = 0);
 
 public:
     ShaderManager();
     ~ShaderManager();
     
+    // Files may pull in shared code with `#include "name"`, resolved relative
+    // to the including file. On failure the current program is left in place
     bool loadShadersFromFiles(const std::string& vertexPath, const std::string& fragmentPath);
     bool loadShadersFromSource(const std::string& vertexSource, const std::string& fragmentSource);
     
     void use() const;
     GLuint getProgram() const { return shaderProgram; }
     
+    // Exchange programs (and their uniform locations), e.g. to install a set
+    // built off to the side only once all of it compiled
+    void swap(ShaderManager& other);
+    
+    // Cached location, -1 if the program has no such active uniform
+    GLint getUniformLocation(const std::string& name) const;
+    
+    // Attach a uniform block to a buffer binding point. Returns false if the
+    // program does not use the block
+    bool bindUniformBlock(const std::string& blockName, GLuint bindingPoint) const;
+    
     // Uniform setters
     void setFloat(const std::string& name, float value) const;
     void setInt(const std::string& name, int value) const;
     void setBool(const std::string& name, bool value) const;
+    void setVec2(const std::string& name, const glm::vec2& value) const;
+    void setVec3Array(const std::string& name, const glm::vec3* values, int count) const;
+    void setMat4(const std::string& name, const glm::mat4& value) const;
     
     void cleanup();
+    
+    // On-disk program binary cache, keyed by a hash of the sources and the
+    // GL vendor/renderer/version strings. Any mismatch or driver rejection
+    // falls back to compiling. glGetProgramBinary (GL 4.1 /
+    // ARB_get_program_binary) is not in the generated 3.3 loader, so call
+    // enableBinaryCache() with the same proc loader right after gladLoadGLLoader
+    static bool enableBinaryCache(GLADloadproc load, const std::string& directory);
+    static void disableBinaryCache();
 };
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "rendering/Renderer.h"
+#include "simulation/ParticleView.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Pure-CPU particle rasteriser for machines without a usable OpenGL stack.
+// Implements the same Renderer::Config look (type/speed colours, glow falloff,
+// point size, pulsation and additive trails). The framebuffer is split into
+// tiles; particles are binned per tile and tiles are splatted in parallel.
+class SoftwareRenderer {
+private:
+    static constexpr int TILE_SIZE = 64;
+    
+    Renderer::Config config;
+    std::vector<glm::vec3> colors;
+    std::vector<glm::vec3> speedGradient;
+    
+    int width, height;
+    int tilesX, tilesY;
+    float time;
+    
+    // Linear RGB accumulation buffer. With trails it holds only the faded
+    // particle history, composited over the background in resolve() as the
+    // GL renderer's trail textures are
+    std::vector<glm::vec3> accum;
+    bool trailsValid;
+    std::vector<unsigned char> pixels; // Resolved RGBA8, top-down
+    
+    // Per-frame splat list, binned by tile (counting sort)
+    struct Splat {
+        float px, py;   // Centre in pixels
+        float size;     // Diameter in pixels
+        glm::vec3 color;
+    };
+    std::vector<Splat> splats;
+    std::vector<int> tileOffsets;
+    std::vector<int> tileSplats;
+    
+    glm::vec3 particleColor(const ParticleView& particles, size_t i) const;
+    void binSplats();
+    void rasterizeTile(int tile);
+    void resolve();
+
+public:
+    SoftwareRenderer();
+    
+    bool initialize(int width, int height);
+    
+    Renderer::Config& getConfig() { return config; }
+    const Renderer::Config& getConfig() const { return config; }
+    
+    // Clears (or fades, with trails) the accumulation buffer
+    void setupFrame();
+    void renderParticles(const ParticleView& particles);
+    
+    // RGBA8 output, valid after renderParticles()
+    const std::vector<unsigned char>& getPixels() const { return pixels; }
+    bool writePNG(const std::string& filename) const;
+    
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+};
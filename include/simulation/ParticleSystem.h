@@ -1,11 +1,15 @@
 #pragma once
 
 #include "simulation/Particle.h"
+#include "simulation/ParticleView.h"
 #include "simulation/SpatialHash.h"
+#include "util/RateCounter.h"
 #include <vector>
 #include <random>
+#include <string>
 #include <glm/glm.hpp>
 #include <chrono>
+#include <cstdint>
 
 class ParticleSystem {
 public:
@@ -13,10 +17,10 @@ public:
     
     struct PerformanceMetrics {
         float updateTimeMs = 0.0f;
-        float renderTimeMs = 0.0f;
         int forceCalculations = 0;
         int spatialQueries = 0;
-        float averageFPS = 0.0f;
+        float stepsPerSecond = 0.0f; // update() calls per second, not rendered frames
+        uint64_t stateHash = 0;      // After the last step, deterministic mode only
         
         void reset() {
             forceCalculations = 0;
@@ -46,6 +50,13 @@ public:
         bool paused = false;
         float timeScale = 1.0f;
         
+        // Reproducible runs: the random sequence restarts from `seed` on every
+        // reset and preset load, and each step's state hash is kept in the
+        // metrics. Bitwise equal across runs and thread counts of one build
+        // (the kernels switch to a copy compiled without fast math)
+        bool deterministic = false;
+        uint32_t seed = 1;
+        
         // Mouse interaction
         float mouseX = -10.0f;
         float mouseY = -10.0f;
@@ -66,19 +77,36 @@ private:
     std::vector<Particle> particles;
     std::vector<std::vector<float>> forces;
     SpatialHash spatialHash;
+    bool spatialHashValid = false; // Indices match `particles` (no add/erase since the build)
+    
+    // Positions before the last step (x, y pairs) for render interpolation.
+    // Wrapped particles get their new position so they do not streak across
+    std::vector<float> previousPositions;
+    bool previousPositionsValid = false;
+    
+    // Step scratch, kept to avoid reallocating every step
+    std::vector<float> forceX, forceY;
+    std::vector<size_t> pendingRemovals; // KILL-mode indices, ascending
     std::mt19937 rng;
     Config config;
     PerformanceMetrics metrics;
     
     // Performance tracking
-    std::chrono::high_resolution_clock::time_point lastUpdateTime;
-    std::vector<float> fpsHistory;
-    const size_t maxFpsHistory = 60;
+    RateCounter stepRate;
+    
+    static inline bool logging = true;
 
     // Helper functions
     float wrapCoord(float x) const;
     glm::vec2 getWrappedDelta(const glm::vec2& from, const glm::vec2& to) const;
-    float calculateForce(float dist, float attraction) const;
+    // Grid candidates around (x, y), plus their images across the edge in WRAP mode
+    void queryNeighbors(float x, float y, std::vector<int>& out) const;
+    
+    // computeForces()/integrate() bodies (ParticleSystemKernels.inl). Strict is
+    // compiled in its own file without fast math or FMA contraction and runs
+    // in deterministic mode; the default path keeps the build's float flags
+    template <bool Strict> void computeForcesKernel();
+    template <bool Strict> void integrateKernel(float dt);
     
 public:
     ParticleSystem();
@@ -100,8 +128,30 @@ public:
     // Particle management
     const std::vector<Particle>& getParticles() const { return particles; }
     std::vector<Particle>& getParticles() { return particles; }
+    // Includes the pre-step positions when they still match `particles`
+    ParticleView getParticleView() const {
+        ParticleView view(particles);
+        if (previousPositionsValid) {
+            view.previousPosition = {previousPositions.data(), 2 * sizeof(float)};
+        }
+        return view;
+    }
+    
+    // Grid built during the last update, for spatial queries outside the
+    // simulation (e.g. view culling). Positions may have moved by up to one
+    // step since. nullptr when disabled or invalidated by adding/removing particles
+    const SpatialHash* getSpatialHash() const {
+        return (config.useSpatialHash && spatialHashValid) ? &spatialHash : nullptr;
+    }
     void createParticles();
     void resetSimulation(bool randomForces = false);
+    // Restart the random sequence: from config.seed in deterministic mode,
+    // otherwise from std::random_device
+    void reseed();
+    // FNV-1a over every particle's position, velocity and type
+    uint64_t computeStateHash() const;
+    // Replace every particle, e.g. with a generated or saved state
+    void setParticles(std::vector<Particle> newParticles);
     
     // Dynamic particle management
     void addParticles(int count, int type = -1); // -1 = random type
@@ -115,10 +165,27 @@ public:
     
     // Presets
     void loadPreset(const std::string& name);
+    static const std::vector<std::string>& presetNames();
+    
+    // "Created N particles" / "Loaded preset" lines on stdout, for every
+    // instance; tools that build many systems turn them off
+    static void setLogging(bool enabled) { logging = enabled; }
     
     // Simulation
     void update(float deltaTime);
     
+    // The phases of update(), in order, for benchmarks. Each needs the ones
+    // before it for the current particle set; dt is in simulation units
+    // (1.0 = one step at 60 steps/s)
+    void buildSpatialHash();
+    void computeForces();
+    void integrate(float dt);
+    void compactParticles();
+    
+    // Per-particle force from the last computeForces(), for validation
+    const std::vector<float>& getForceX() const { return forceX; }
+    const std::vector<float>& getForceY() const { return forceY; }
+    
     // Utility methods
     int getParticleCount() const { return particles.size(); }
     
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "simulation/Particle.h"
+#include <cstddef>
+#include <vector>
+
+// Non-owning view of particle state as strided attribute streams.
+// Both the AoS particle vector and separate SoA arrays map onto it without a
+// copy, so the renderer can bind each stream directly as a vertex attribute.
+struct ParticleView {
+    struct Stream {
+        const void* data = nullptr;
+        size_t stride = 0; // Bytes between consecutive elements
+        
+        template <typename T>
+        const T* at(size_t i) const {
+            return reinterpret_cast<const T*>(static_cast<const char*>(data) + i * stride);
+        }
+    };
+    
+    Stream position; // float x, y
+    Stream velocity; // float vx, vy
+    Stream type;     // int
+    Stream previousPosition; // Optional float x, y before the last step
+    size_t count = 0;
+    
+    ParticleView() = default;
+    
+    ParticleView(const std::vector<Particle>& particles) : count(particles.size()) {
+        const Particle* base = particles.data();
+        position = {&base->x, sizeof(Particle)};
+        velocity = {&base->vx, sizeof(Particle)};
+        type = {&base->type, sizeof(Particle)};
+    }
+    
+    ParticleView(const float* xy, const float* vxy, const int* types, size_t n) : count(n) {
+        position = {xy, 2 * sizeof(float)};
+        velocity = {vxy, 2 * sizeof(float)};
+        type = {types, sizeof(int)};
+    }
+    
+    bool empty() const { return count == 0; }
+    
+    // Every `step`-th particle, still without a copy
+    ParticleView subsample(size_t step) const {
+        if (step <= 1) return *this;
+        ParticleView view = *this;
+        for (Stream* stream : {&view.position, &view.velocity, &view.type, &view.previousPosition}) {
+            stream->stride *= step;
+        }
+        view.count = (count + step - 1) / step;
+        return view;
+    }
+    
+    // True when all streams live inside one strided block (the AoS layout),
+    // which lets the renderer upload a single contiguous range.
+    bool isInterleaved() const {
+        const char* base = static_cast<const char*>(position.data);
+        auto inside = [&](const Stream& s) {
+            const char* p = static_cast<const char*>(s.data);
+            return s.stride == position.stride && p >= base && p < base + position.stride;
+        };
+        return inside(velocity) && inside(type);
+    }
+    
+    float x(size_t i) const { return position.at<float>(i)[0]; }
+    float y(size_t i) const { return position.at<float>(i)[1]; }
+    float vx(size_t i) const { return velocity.at<float>(i)[0]; }
+    float vy(size_t i) const { return velocity.at<float>(i)[1]; }
+    bool hasPrevious() const { return previousPosition.data != nullptr; }
+    float previousX(size_t i) const { return previousPosition.at<float>(i)[0]; }
+    float previousY(size_t i) const { return previousPosition.at<float>(i)[1]; }
+    int typeAt(size_t i) const { return *type.at<int>(i); }
+};
@@ -3,14 +3,19 @@
 #include <unordered_map>
 #include <vector>
 #include <cmath>
+#include <cstdint>
 
 class SpatialHash {
 private:
     float cellSize;
-    std::unordered_map<int, std::vector<int>> grid;
+    std::unordered_map<int64_t, std::vector<int>> grid;
     
-    int hash(int x, int y) const {
-        return x * 73856093 ^ y * 19349663;
+    // Both cell coordinates packed into one key, so two cells never share a
+    // bucket (a shared bucket would return its particles twice to a query
+    // that overlaps both cells)
+    static int64_t hash(int x, int y) {
+        return static_cast<int64_t>(static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 |
+                                    static_cast<uint32_t>(y));
     }
     
 public:
@@ -27,6 +32,11 @@ public:
     // Efficient version that reuses an existing vector (avoids allocation)
     void queryInto(float x, float y, float radius, std::vector<int>& result) const {
         result.clear();
+        appendQuery(x, y, radius, result);
+    }
+    
+    // Like queryInto, but keeps what `result` already holds
+    void appendQuery(float x, float y, float radius, std::vector<int>& result) const {
         int minX = static_cast<int>(std::floor((x - radius) / cellSize));
         int maxX = static_cast<int>(std::floor((x + radius) / cellSize));
         int minY = static_cast<int>(std::floor((y - radius) / cellSize));
@@ -42,6 +52,24 @@ public:
         }
     }
     
+    // Collect every index stored in the cells overlapping a rectangle
+    void queryRectInto(float minX, float minY, float maxX, float maxY, std::vector<int>& result) const {
+        result.clear();
+        const int minCX = static_cast<int>(std::floor(minX / cellSize));
+        const int maxCX = static_cast<int>(std::floor(maxX / cellSize));
+        const int minCY = static_cast<int>(std::floor(minY / cellSize));
+        const int maxCY = static_cast<int>(std::floor(maxY / cellSize));
+
+        for (int cy = minCY; cy <= maxCY; ++cy) {
+            for (int cx = minCX; cx <= maxCX; ++cx) {
+                auto it = grid.find(hash(cx, cy));
+                if (it != grid.end()) {
+                    result.insert(result.end(), it->second.begin(), it->second.end());
+                }
+            }
+        }
+    }
+
     // Legacy method (less efficient, kept for compatibility)
     std::vector<int> query(float x, float y, float radius) const {
         std::vector<int> result;
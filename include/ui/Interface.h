@@ -2,14 +2,21 @@
 
 #include "simulation/ParticleSystem.h"
 #include "rendering/Renderer.h"
+#include "util/PerfCounters.h"
 #include <imgui.h>
 #include <glm/glm.hpp>
 #include <memory>
 
+class FramePacer;
+class Profiler;
+class QualityGovernor;
+
 class Interface {
 private:
     ParticleSystem& particleSystem;
     Renderer& renderer;
+    FramePacer* framePacer = nullptr; // Optional: pacing controls and frame rate
+    QualityGovernor* governor = nullptr; // Optional: automatic quality controls
     
     // Temporary state for structure changes
     struct TempConfig {
@@ -24,12 +31,18 @@ private:
     bool showVisualEffects = false;
     bool showInteraction = false;
     
+    // Hardware counter figures, refreshed a few times per second
+    std::array<PerfCounters::RegionStats, PerfCounters::REGION_COUNT> perfStats;
+    double perfCollectTime = 0.0;
+    
     // Modern panel rendering functions
     void setupModernStyle();
     void renderMainControlPanel();
     void renderAdvancedSettingsPanel();
     void renderQuickActionsPanel();
     void renderPerformanceHUD();
+    void renderProfilerZones(const Profiler& profiler);
+    void renderPerfCounters();
     void renderForceMatrixPanel();
     
     // Helper function for particle type colors
@@ -55,4 +68,7 @@ public:
     bool initialize();
     void cleanup();
     void render();
+    
+    void setFramePacer(FramePacer* pacer) { framePacer = pacer; }
+    void setQualityGovernor(QualityGovernor* qualityGovernor) { governor = qualityGovernor; }
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+
+// Non-blocking change detection for the files in one directory. Uses inotify
+// on Linux and falls back to polling modification times elsewhere (or when
+// inotify is unavailable). Bursts of events, e.g. an editor truncating and
+// rewriting a file, are reported once after the directory has been quiet for
+// a short settle time.
+class FileWatcher {
+private:
+    std::string directory;
+    int inotifyFd;
+    
+    // Polling fallback
+    std::map<std::string, std::filesystem::file_time_type> modificationTimes;
+    std::chrono::steady_clock::time_point lastScan;
+    
+    bool pending;
+    std::chrono::steady_clock::time_point lastChange;
+    
+    bool readEvents();
+    bool scanModificationTimes();
+
+public:
+    explicit FileWatcher(const std::string& directory);
+    ~FileWatcher();
+    
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    
+    // True once per settled batch of changes since the last call
+    bool poll();
+    
+    bool usesInotify() const { return inotifyFd >= 0; }
+    const std::string& getDirectory() const { return directory; }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "util/RateCounter.h"
+
+// Decides, once per main-loop iteration, how many simulation steps to run
+// and whether to render. Times are in seconds from any monotonic clock.
+class FramePacer {
+public:
+    enum Mode {
+        VSYNC,              // Fixed-rate steps, rendering locked to the display refresh
+        UNCAPPED,           // One step and one frame per iteration, no swap interval
+        FIXED_INTERPOLATED, // Fixed-rate steps, render as fast as possible between them
+        SIM_MAX_RENDER_30   // Step as fast as possible, render at 30 Hz
+    };
+    static const char* modeName(Mode mode);
+    
+    struct Config {
+        Mode mode = VSYNC;
+        float stepRate = 60.0f;     // Simulation steps per second in VSYNC / FIXED_INTERPOLATED
+        float maxFrameTime = 0.25f; // Time dropped beyond this to avoid a spiral of death
+    };
+    
+    static constexpr double SIM_MAX_RENDER_INTERVAL = 1.0 / 30.0;
+
+private:
+    Config config;
+    double lastTime;
+    double accumulator;
+    double lastRenderTime;
+    bool started;
+    
+    RateCounter frameRate;
+    float renderTimeMs;
+
+public:
+    FramePacer();
+    
+    Config& getConfig() { return config; }
+    const Config& getConfig() const { return config; }
+    
+    bool usesVsync() const { return config.mode == VSYNC; }
+    
+    // Start of a loop iteration: number of steps of getStepDelta() to run now
+    int beginFrame(double now);
+    double getStepDelta() const;
+    
+    bool shouldRender(double now) const;
+    void frameRendered(double now, float renderTimeMs);
+    
+    // Fraction of a fixed step accumulated past the last simulated state
+    float getInterpolationAlpha() const;
+    
+    float getFramesPerSecond() const { return frameRate.getRate(); }
+    float getRenderTimeMs() const { return renderTimeMs; }
+    
+    // Drop accumulated time, e.g. after a lockstep recording
+    void resetAccumulator() { accumulator = 0.0; }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Hardware counters (cycles, instructions, cache and branch misses) around
+// the grid build and the force kernel, read with perf_event_open on Linux.
+// Every thread opens its own counter group the first time it enters a
+// region and adds its deltas to shared totals, so OpenMP workers are
+// included. Without kernel support, permission or a PMU (common in VMs)
+// isAvailable() is false and scopes cost one branch.
+class PerfCounters {
+public:
+    enum Counter {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        COUNTER_COUNT
+    };
+    static const char* counterName(Counter counter);
+
+    enum Region {
+        GRID_BUILD,
+        FORCES,
+        REGION_COUNT
+    };
+    static const char* regionName(Region region);
+
+    // Counts since the previous collect()
+    struct RegionStats {
+        bool valid = false;
+        std::array<bool, COUNTER_COUNT> supported{};
+        std::array<double, COUNTER_COUNT> values{};
+        uint64_t particles = 0; // Particle visits: particles times steps
+
+        double ipc() const;
+        double perParticle(Counter counter) const;
+    };
+
+    // Adds the calling thread's counts between construction and stop()
+    class Scope {
+    private:
+        Region region;
+        bool active;
+        std::array<uint64_t, COUNTER_COUNT> start;
+        uint64_t startEnabled;
+        uint64_t startRunning;
+
+    public:
+        explicit Scope(Region region);
+        ~Scope() { stop(); }
+        void stop();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    std::atomic<bool> enabled;
+    std::atomic<bool> failed; // Opening failed once; not retried on every step
+    std::mutex errorMutex;
+    std::string error;
+
+    std::array<std::array<std::atomic<uint64_t>, COUNTER_COUNT>, REGION_COUNT> totals{};
+    std::array<std::array<std::atomic<bool>, COUNTER_COUNT>, REGION_COUNT> seen{};
+    std::array<std::atomic<uint64_t>, REGION_COUNT> particles{};
+
+    PerfCounters();
+    void fail(const std::string& reason);
+
+public:
+    static PerfCounters& instance();
+
+    // Off by default; the first region entered after enabling opens the counters
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Opens the calling thread's counters if needed; false with getError() set
+    // when they cannot be used
+    bool isAvailable();
+    std::string getError();
+
+    // Work done in a region, for per-particle figures
+    void countParticles(Region region, size_t count) {
+        particles[region].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Totals since the previous call (or reset), then start over
+    void collect(std::array<RegionStats, REGION_COUNT>& out);
+    void reset();
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+// Scoped-zone timer for the phases of a simulation step and a rendered frame.
+// Each thread writes finished zones into its own ring buffer without locking.
+// Once per frame, endFrame() drains every ring into per-zone frame totals;
+// percentiles and the frame-time graph come from the last HISTORY frames.
+// The timeline of the last TRACE_FRAMES frames is kept as well and can be
+// written as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+class Profiler {
+public:
+    // Fixed zone set, so recording is an array index rather than a lookup
+    enum Zone {
+        GRID_BUILD,
+        FORCES,
+        NEIGHBOR_QUERY, // Nested in FORCES, timed per thread
+        INTEGRATE,
+        COMPACTION,
+        CREATE_PARTICLES,
+        VERTEX_BUILD,
+        UPLOAD,
+        DRAW,           // CPU-side submission; the GPU finishes asynchronously
+        UI,
+        ZONE_COUNT
+    };
+    static const char* zoneName(Zone zone);
+    static Zone zoneParent(Zone zone); // ZONE_COUNT for top-level zones
+    
+    static constexpr size_t HISTORY = 240;
+    static constexpr size_t TRACE_FRAMES = 600;
+    
+    struct ZoneStats {
+        float p50Ms = 0.0f;
+        float p95Ms = 0.0f;
+        float p99Ms = 0.0f;
+    };
+    
+    // Times one zone from construction to destruction
+    class Scope {
+    private:
+        Zone zone;
+        uint64_t start;
+    
+    public:
+        explicit Scope(Zone zone);
+        ~Scope() { stop(); }
+        // End the zone before the scope does
+        void stop();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+    
+    // Monotonic nanoseconds, 0 when profiling is off
+    static uint64_t now();
+
+private:
+    // Single producer (the owning thread), single consumer (endFrame). The
+    // second word packs the zone into the top byte and the duration below
+    // it. Slots the producer may have lapped while they were read are
+    // discarded, so a torn start/duration pair is never used.
+    struct Slot {
+        std::atomic<uint64_t> start{0}; // 0 for totals with no place on the timeline
+        std::atomic<uint64_t> packed{0};
+    };
+    struct ThreadRing {
+        static constexpr size_t CAPACITY = 4096;
+        std::array<Slot, CAPACITY> events{};
+        std::atomic<uint64_t> written{0};
+        uint64_t read = 0;
+    };
+    
+    struct TraceEvent {
+        uint32_t thread;
+        uint32_t zone;
+        uint64_t start;
+        uint64_t duration;
+    };
+    struct TraceFrame {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        std::vector<TraceEvent> events;
+    };
+    
+    std::atomic<bool> enabled;
+    std::mutex ringsMutex; // Taken when a thread registers and by endFrame, never per event
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    
+    std::array<std::array<float, HISTORY>, ZONE_COUNT> history{}; // Milliseconds per frame
+    std::vector<std::array<uint64_t, ZONE_COUNT>> threadTotals;  // Nanoseconds per ring since reset()
+    size_t frames;
+    size_t next;
+    uint64_t droppedEvents;
+    
+    // Timeline, reusing each frame's event storage once the ring wraps
+    std::vector<TraceFrame> traceFrames;
+    size_t traceCount;
+    size_t traceNext;
+    uint64_t lastFrameEnd;
+    size_t mainThread;
+    std::string pendingTracePath;
+    size_t pendingTraceFrames;
+    size_t pendingTraceRemaining;
+    std::unique_ptr<WorkerPool> traceWriter; // Created on the first save
+    
+    Profiler();
+    ~Profiler();
+    ThreadRing& threadRing();
+    size_t slot(size_t frame) const;
+    static bool writeTrace(const std::string& path, const std::vector<TraceFrame>& frames,
+                           size_t threadCount, size_t mainThread);
+
+public:
+    static Profiler& instance();
+    
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    // Safe from any thread. Without a start time the duration still counts
+    // towards the frame totals but stays off the trace timeline
+    void record(Zone zone, uint64_t nanoseconds, uint64_t start = 0);
+    
+    // Main thread, once per rendered frame: everything recorded since the
+    // previous call becomes one frame. A zone run on several threads counts
+    // its slowest thread, which is what the frame waited for.
+    void endFrame();
+    
+    // Forget history and anything not yet drained, e.g. after a warm-up
+    void reset();
+    
+    // Percentiles over the frames in history
+    ZoneStats getStats(Zone zone) const;
+    
+    size_t getFrameCount() const { return frames; }
+    // Frame 0 is the oldest kept
+    float getFrameMs(Zone zone, size_t frame) const { return history[zone][slot(frame)]; }
+    // Excluding nested zones, so self times stack to the frame total
+    float getSelfMs(Zone zone, size_t frame) const;
+    
+    // Milliseconds each thread spent in `zone` over the frames since the last
+    // reset(), one entry per thread that has recorded anything (main first
+    // registered, then workers). Shows how evenly a parallel zone's work spread
+    std::vector<double> getThreadMs(Zone zone) const;
+    
+    // Events overwritten before they were drained
+    uint64_t getDroppedEvents() const { return droppedEvents; }
+    
+    // Write the last `frameCount` frames as a trace. The frames are copied
+    // here and formatted and written on a background thread; false if there
+    // is nothing to write
+    bool saveTrace(const std::string& path, size_t frameCount = TRACE_FRAMES);
+    // Save the next `frameCount` frames once they have been rendered
+    void traceNextFrames(const std::string& path, size_t frameCount);
+    bool isTracePending() const { return pendingTraceRemaining > 0; }
+    // Block until every queued trace is on disk
+    void waitForTraces();
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+// Events per second over the most recent intervals. The rate is the event
+// count divided by the elapsed time, so one long stall weighs as much as it
+// lasted instead of being averaged away with many short intervals.
+class RateCounter {
+private:
+    static constexpr size_t WINDOW = 60;
+    std::array<double, WINDOW> intervals{};
+    size_t count = 0;
+    size_t next = 0;
+    double total = 0.0;
+    std::chrono::steady_clock::time_point last;
+    bool started = false;
+
+public:
+    void tick() {
+        const auto now = std::chrono::steady_clock::now();
+        if (started) {
+            const double seconds = std::chrono::duration<double>(now - last).count();
+            if (count == WINDOW) {
+                total -= intervals[next];
+            } else {
+                ++count;
+            }
+            intervals[next] = seconds;
+            total += seconds;
+            next = (next + 1) % WINDOW;
+        }
+        last = now;
+        started = true;
+    }
+    
+    // Forget history, e.g. after a pause
+    void reset() {
+        count = next = 0;
+        total = 0.0;
+        started = false;
+    }
+    
+    float getRate() const {
+        return total > 0.0 ? static_cast<float>(static_cast<double>(count) / total) : 0.0f;
+    }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of background threads draining a FIFO task queue.
+// With a non-zero capacity, submit() blocks while the queue is full, which
+// gives producers natural back-pressure instead of unbounded memory growth.
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    mutable std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable spaceAvailable;
+    std::condition_variable idle;
+    size_t capacity;
+    size_t active;
+    bool stopping;
+    
+    void workerLoop();
+
+public:
+    explicit WorkerPool(int threadCount, size_t capacity = 0);
+    ~WorkerPool();
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    // Enqueue a task; blocks while the queue is at capacity
+    void submit(std::function<void()> task);
+    
+    // Block until the queue is empty and no task is running
+    void waitIdle();
+    
+    size_t queued() const;
+    size_t getCapacity() const { return capacity; }
+};
@@ -0,0 +1,28 @@
+#version 330 core
+// Density mode: blend the palette by per-type counts, brightness from the total
+#include "render_params.glsl"
+
+in vec2 vUV;
+out vec4 FragColor;
+uniform sampler2DArray uDensity;
+uniform int uLayers;
+uniform float uExposure;
+uniform mat4 uInvView;
+
+void main() {
+    // Screen -> world -> grid coordinates
+    vec2 world = (uInvView * vec4(vUV * 2.0 - 1.0, 0.0, 1.0)).xy;
+    vec2 uv = world * 0.5 + 0.5;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) discard;
+    
+    vec3 weighted = vec3(0.0);
+    float total = 0.0;
+    for (int i = 0; i < uLayers; ++i) {
+        float d = texture(uDensity, vec3(uv, float(i))).r;
+        weighted += uPalette[i].rgb * d;
+        total += d;
+    }
+    if (total <= 0.0) discard;
+    float brightness = 1.0 - exp(-total * uExposure);
+    FragColor = vec4(weighted / total * brightness, 1.0);
+}
@@ -1,7 +1,6 @@
 #version 330 core
-in vec3 fragColor;
-out vec4 FragColor;
+#include "sprite_common.glsl"
 
 void main() {
-    FragColor = vec4(fragColor, 1.0);
+    FragColor = shadeSprite(gl_PointCoord - vec2(0.5));
 }
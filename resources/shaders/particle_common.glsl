@@ -0,0 +1,40 @@
+// Attribute layout and colour/size rules shared by every particle vertex shader
+#include "render_params.glsl"
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in uint aType;
+layout (location = 2) in vec2 aMotion;
+layout (location = 3) in vec2 aPreviousPos;
+out vec3 vColor;
+
+// Blend between the last two simulation states. When no previous stream is
+// bound uInterpolation is 1, so aPreviousPos (then a constant) drops out
+vec2 particlePosition() {
+    return mix(aPreviousPos, aPos, uInterpolation);
+}
+
+vec3 speedColor(float t) {
+    float s = clamp(t, 0.0, 1.0) * 4.0;
+    int i = min(int(s), 3);
+    return mix(uSpeedGradient[i].rgb, uSpeedGradient[i + 1].rgb, s - float(i));
+}
+
+// Packed vertices carry velocity / maxSpeed; direct streams carry raw velocity
+vec2 particleVelocity() {
+    return aMotion * uSpeedScale;
+}
+
+float particleSpeed() {
+    return length(particleVelocity());
+}
+
+vec3 particleColor() {
+    return uColorBySpeed ? speedColor(particleSpeed())
+                         : uPalette[int(aType) % uPaletteSize].rgb;
+}
+
+float particleSize() {
+    float size = uSizeBySpeed ? mix(uMinSize, uMaxSize, clamp(particleSpeed(), 0.0, 1.0))
+                              : uPointSize;
+    return max(size * uSizeScale, 1.0);
+}
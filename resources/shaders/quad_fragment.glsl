@@ -0,0 +1,8 @@
+#version 330 core
+#include "sprite_common.glsl"
+
+in vec2 vCoord;
+
+void main() {
+    FragColor = shadeSprite(vCoord);
+}
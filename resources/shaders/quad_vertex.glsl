@@ -0,0 +1,14 @@
+#version 330 core
+// Instanced path: one quad per particle, corners generated from gl_VertexID
+// so sprite size is not limited by GL_POINT_SIZE_RANGE
+#include "particle_common.glsl"
+
+out vec2 vCoord;
+
+void main() {
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec4 center = uView * vec4(particlePosition(), 0.0, 1.0);
+    gl_Position = vec4(center.xy + corner * particleSize() / uViewportSize, 0.0, 1.0);
+    vCoord = corner * 0.5;
+    vColor = particleColor();
+}
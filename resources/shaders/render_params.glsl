@@ -0,0 +1,20 @@
+// Per-frame parameters shared by every program: one std140 block,
+// mirrored by Renderer::RenderParams and written with a single buffer update
+layout (std140) uniform RenderParams {
+    mat4 uView;
+    vec4 uPalette[8];
+    vec4 uSpeedGradient[5];
+    float uPointSize;
+    float uMinSize;
+    float uMaxSize;
+    float uSizeScale;
+    float uSpeedScale;
+    float uTime;
+    float uVectorLength;
+    int uPaletteSize;
+    vec2 uViewportSize;
+    bool uColorBySpeed;
+    bool uSizeBySpeed;
+    bool uEnableGlow;
+    float uInterpolation; // 1 = current positions only
+};
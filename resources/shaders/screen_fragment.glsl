@@ -0,0 +1,17 @@
+#version 330 core
+// Trail fade and composite
+in vec2 vUV;
+out vec4 FragColor;
+uniform sampler2D uTexture;
+uniform float uScale;
+uniform bool uPreserveHue;
+
+void main() {
+    vec4 color = texture(uTexture, vUV) * uScale;
+    if (uPreserveHue) {
+        // Dense areas saturate towards their own colour, not white
+        float peak = max(max(color.r, color.g), color.b);
+        color.rgb /= max(peak, 1.0);
+    }
+    FragColor = color;
+}
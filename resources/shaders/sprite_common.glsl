@@ -0,0 +1,19 @@
+// Round, soft-edged sprite shared by the point and quad paths
+#include "render_params.glsl"
+
+in vec3 vColor;
+out vec4 FragColor;
+
+vec4 shadeSprite(vec2 coord) {
+    float dist = length(coord);
+    if (dist > 0.5) discard;
+    float alpha = smoothstep(0.5, 0.35, dist);
+    
+    vec3 color = vColor;
+    if (uEnableGlow) {
+        float glow = exp(-dist * 3.0);
+        color = mix(vColor, vec3(1.0), glow * 0.4);
+    }
+    
+    return vec4(color, alpha);
+}
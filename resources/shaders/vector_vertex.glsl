@@ -0,0 +1,10 @@
+#version 330 core
+// Velocity vectors: each instance is a two-vertex line from the particle
+// along its velocity, so no line list is built on the CPU
+#include "particle_common.glsl"
+
+void main() {
+    vec2 tip = particlePosition() + particleVelocity() * uVectorLength * float(gl_VertexID);
+    gl_Position = uView * vec4(tip, 0.0, 1.0);
+    vColor = particleColor();
+}
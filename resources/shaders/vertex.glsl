@@ -1,10 +1,9 @@
 #version 330 core
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec3 aColor;
-
-out vec3 fragColor;
+// GL_POINTS sprite path
+#include "particle_common.glsl"
 
 void main() {
-    gl_Position = vec4(aPos, 0.0, 1.0);
-    fragColor = aColor;
-}
\ No newline at end of file
+    gl_Position = uView * vec4(particlePosition(), 0.0, 1.0);
+    gl_PointSize = particleSize();
+    vColor = particleColor();
+}
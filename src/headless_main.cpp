@@ -0,0 +1,569 @@
+#include <glad/glad.h>
+
+#include "simulation/ParticleSystem.h"
+#include "rendering/Renderer.h"
+#include "rendering/ShaderManager.h"
+#include "rendering/SoftwareRenderer.h"
+#include "rendering/FrameCapture.h"
+#include "rendering/FrameRecorder.h"
+#include "util/PerfCounters.h"
+#include "util/Profiler.h"
+#ifdef PARTICLELIFE_HAS_EGL
+#include "rendering/HeadlessContext.h"
+#endif
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <iomanip>
+#include <fstream>
+#include "stb_image_write.h"
+
+// Offscreen batch renderer: simulates a preset, renders it with no window and
+// reports measured throughput. Intended for parameter sweeps on CPU-only
+// servers and CI. "gl" renders into an EGL-backed FBO (Mesa llvmpipe works),
+// "cpu" uses the tiled software rasteriser and needs no GL stack at all.
+
+struct HeadlessOptions {
+    int width = 512;
+    int height = 512;
+    int steps = 300;          // Simulation steps before measuring
+    int frames = 120;         // Rendered (and measured) frames
+    int particlesPerType = 200;
+    std::string preset;
+    std::string output = "headless.png";
+#ifdef PARTICLELIFE_HAS_EGL
+    std::string renderer = "gl";
+#else
+    std::string renderer = "cpu";
+#endif
+    bool trails = false;
+    bool halfResTrails = false;
+    bool colorBySpeed = false;
+    int densityResolution = 0; // 0 = draw particles individually
+    bool instancedQuads = false;
+    bool sizeBySpeed = false;
+    bool velocityVectors = false;
+    bool compactVertices = false;
+    bool spriteBench = false;
+    std::string shaderCache = "shader_cache"; // Empty disables the binary cache
+    std::string shaderDir;                    // Empty = Renderer::defaultShaderDirectory()
+    float zoom = 1.0f;
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    std::string recordPath;   // *.y4m file or PNG sequence directory
+    int recordEvery = 1;
+    std::string tracePath;    // Chrome trace JSON of the timed frames
+    bool perfCounters = false;
+    int64_t seed = -1;        // >= 0 runs deterministically from this seed
+    std::string hashPath;     // Per-step state hashes, deterministic runs only
+};
+
+static void printUsage() {
+    std::cout << "Usage: particlelife_headless [options]\n"
+              << "  --width N          Framebuffer width (default 512)\n"
+              << "  --height N         Framebuffer height (default 512)\n"
+              << "  --steps N          Simulation steps before measuring (default 300)\n"
+              << "  --frames N         Frames to render and time (default 120)\n"
+              << "  --particles N      Particles per type (default 200)\n"
+              << "  --preset NAME      Orbits, Chaos, Balance, Swirls or Snakes\n"
+              << "  --output FILE      PNG written from the last frame (default headless.png)\n"
+              << "  --renderer gl|cpu  EGL offscreen GL or software rasteriser\n"
+              << "  --trails           Enable additive trails\n"
+              << "  --half-res-trails  Accumulate trails at half resolution (gl only)\n"
+              << "  --speed-colors     Colour particles by speed\n"
+              << "  --density N        Draw an N x N density heatmap instead of particles (gl only)\n"
+              << "  --quads            Draw instanced quads instead of GL_POINTS (gl only)\n"
+              << "  --size-by-speed    Scale sprites with particle speed\n"
+              << "  --vectors          Draw velocity vectors (gl only)\n"
+              << "  --compact          Upload quantised 8-byte vertices (gl only)\n"
+              << "  --sprite-bench     Time points vs instanced quads at 10k/100k/1M particles (gl only)\n"
+              << "  --shader-cache DIR Program binary cache directory, \"\" to disable (default shader_cache)\n"
+              << "  --shader-dir DIR   Load GLSL sources from DIR (gl only)\n"
+              << "  --zoom Z           Camera zoom, culled to the visible grid cells (gl only)\n"
+              << "  --center X,Y       Camera centre in world coordinates (gl only)\n"
+              << "  --record PATH      Record frames to PATH (*.y4m file, otherwise a PNG directory)\n"
+              << "  --record-every N   Record every Nth frame (default 1)\n"
+              << "  --trace FILE       Write the timed frames as Chrome trace JSON (last 600 at most)\n"
+              << "  --perf-counters    Report IPC and misses per particle from hardware counters (Linux)\n"
+              << "  --seed N           Deterministic run from seed N; prints the final state hash\n"
+              << "  --hashes FILE      With --seed, write \"step hash\" for every simulation step\n";
+}
+
+// A whole decimal number that fits in uint32_t; atoi would take "-3" or "12abc"
+static bool parseSeed(const char* text, int64_t& seed) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0' || value > UINT32_MAX) return false;
+    seed = static_cast<int64_t>(value);
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return false;
+        }
+        if (arg == "--trails") {
+            options.trails = true;
+            continue;
+        }
+        if (arg == "--half-res-trails") {
+            options.trails = true;
+            options.halfResTrails = true;
+            continue;
+        }
+        if (arg == "--quads") {
+            options.instancedQuads = true;
+            continue;
+        }
+        if (arg == "--size-by-speed") {
+            options.sizeBySpeed = true;
+            continue;
+        }
+        if (arg == "--compact") {
+            options.compactVertices = true;
+            continue;
+        }
+        if (arg == "--perf-counters") {
+            options.perfCounters = true;
+            continue;
+        }
+        if (arg == "--vectors") {
+            options.velocityVectors = true;
+            continue;
+        }
+        if (arg == "--sprite-bench") {
+            options.spriteBench = true;
+            continue;
+        }
+        if (arg == "--speed-colors") {
+            options.colorBySpeed = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--width") options.width = std::atoi(value);
+        else if (arg == "--height") options.height = std::atoi(value);
+        else if (arg == "--steps") options.steps = std::atoi(value);
+        else if (arg == "--frames") options.frames = std::atoi(value);
+        else if (arg == "--particles") options.particlesPerType = std::atoi(value);
+        else if (arg == "--preset") options.preset = value;
+        else if (arg == "--output") options.output = value;
+        else if (arg == "--renderer") options.renderer = value;
+        else if (arg == "--density") options.densityResolution = std::atoi(value);
+        else if (arg == "--shader-cache") options.shaderCache = value;
+        else if (arg == "--shader-dir") options.shaderDir = value;
+        else if (arg == "--zoom") options.zoom = static_cast<float>(std::atof(value));
+        else if (arg == "--center") {
+            char* end = nullptr;
+            options.centerX = std::strtof(value, &end);
+            options.centerY = (end && *end == ',') ? std::strtof(end + 1, nullptr) : 0.0f;
+        }
+        else if (arg == "--record") options.recordPath = value;
+        else if (arg == "--record-every") options.recordEvery = std::atoi(value);
+        else if (arg == "--trace") options.tracePath = value;
+        else if (arg == "--seed") {
+            if (!parseSeed(value, options.seed)) {
+                std::cerr << "Invalid --seed: " << value << " (expected 0 to 4294967295)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--hashes") options.hashPath = value;
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return false;
+        }
+    }
+    return options.width > 0 && options.height > 0 && options.frames > 0;
+}
+
+// Per-step state hashes of a deterministic run, when --hashes is given
+static std::ofstream hashLog;
+static int hashStep = 0;
+
+static void stepSimulation(ParticleSystem& particleSystem, float deltaTime) {
+    particleSystem.update(deltaTime);
+    if (hashLog.is_open()) {
+        hashLog << hashStep++ << " " << std::hex << std::setw(16) << std::setfill('0')
+                << particleSystem.getMetrics().stateHash << std::dec << std::setfill(' ') << "\n";
+    }
+}
+
+struct FrameTimings {
+    double renderSeconds = 0.0;
+    double frameSeconds = 0.0;
+};
+
+// Runs `frames` simulate+render iterations. Render time is measured on its
+// own, so the render callback must block until the frame is complete
+template <typename RenderFn>
+static FrameTimings runFrames(ParticleSystem& particleSystem, int frames, RenderFn render) {
+    using Clock = std::chrono::high_resolution_clock;
+    const float fixedDeltaTime = 1.0f / 60.0f;
+    
+    FrameTimings timings;
+    Profiler::instance().reset(); // Zones from warm-up steps are not frames
+    PerfCounters::instance().reset();
+    auto frameStart = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        stepSimulation(particleSystem, fixedDeltaTime);
+        
+        auto renderStart = Clock::now();
+        render(particleSystem.getParticleView());
+        timings.renderSeconds += std::chrono::duration<double>(Clock::now() - renderStart).count();
+        Profiler::instance().endFrame();
+    }
+    timings.frameSeconds = std::chrono::duration<double>(Clock::now() - frameStart).count();
+    return timings;
+}
+
+static void printZoneReport(const Profiler& profiler) {
+    if (profiler.getFrameCount() == 0) return;
+    
+    std::cout << "Zone (ms, last " << profiler.getFrameCount() << " frames)       p50      p95      p99" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (int i = 0; i < Profiler::ZONE_COUNT; ++i) {
+        const auto zone = static_cast<Profiler::Zone>(i);
+        const Profiler::ZoneStats stats = profiler.getStats(zone);
+        const std::string name = (Profiler::zoneParent(zone) != Profiler::ZONE_COUNT ? "  " : "") +
+                                 std::string(Profiler::zoneName(zone));
+        std::cout << "  " << std::left << std::setw(30) << name << std::right
+                  << std::setw(9) << stats.p50Ms << std::setw(9) << stats.p95Ms
+                  << std::setw(9) << stats.p99Ms << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+static void printCounterReport() {
+    PerfCounters& counters = PerfCounters::instance();
+    if (!counters.isEnabled()) return;
+    if (!counters.isAvailable()) {
+        std::cout << "Hardware counters: " << counters.getError() << std::endl;
+        return;
+    }
+    
+    std::array<PerfCounters::RegionStats, PerfCounters::REGION_COUNT> stats;
+    counters.collect(stats);
+    std::cout << "Counters (per particle per step)      IPC   L1D miss   LLC miss   branch miss" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (int i = 0; i < PerfCounters::REGION_COUNT; ++i) {
+        std::cout << "  " << std::left << std::setw(30) << PerfCounters::regionName(static_cast<PerfCounters::Region>(i))
+                  << std::right;
+        if (!stats[i].valid) {
+            std::cout << "  not measured" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(9) << stats[i].ipc();
+        for (PerfCounters::Counter counter : {PerfCounters::L1D_MISSES, PerfCounters::LLC_MISSES,
+                                              PerfCounters::BRANCH_MISSES}) {
+            if (stats[i].supported[counter]) {
+                std::cout << std::setw(11) << stats[i].perParticle(counter);
+            } else {
+                std::cout << std::setw(11) << "n/a";
+            }
+        }
+        std::cout << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+static void applyRenderOptions(Renderer::Config& config, const HeadlessOptions& options) {
+    config.enableTrails = options.trails;
+    config.halfResolutionTrails = options.halfResTrails;
+    config.colorBySpeed = options.colorBySpeed;
+    config.instancedQuads = options.instancedQuads;
+    config.sizeBySpeed = options.sizeBySpeed;
+    config.showVelocityVectors = options.velocityVectors;
+    config.compactVertices = options.compactVertices;
+    if (options.densityResolution > 0) {
+        config.densityMode = true;
+        config.densityResolution = options.densityResolution;
+    }
+}
+
+#ifdef PARTICLELIFE_HAS_EGL
+// Context plus renderer, with the shader binary cache in between so repeated
+// launches skip GLSL compilation
+static bool initializeGL(HeadlessContext& context, Renderer& renderer, const HeadlessOptions& options) {
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!context.initialize(options.width, options.height)) {
+        return false;
+    }
+    if (!options.shaderCache.empty()) {
+        ShaderManager::enableBinaryCache(HeadlessContext::getProcLoader(), options.shaderCache);
+    }
+    if (!options.shaderDir.empty()) {
+        renderer.setShaderDirectory(options.shaderDir);
+    }
+    
+    if (!renderer.initialize()) {
+        std::cerr << "Failed to initialize renderer" << std::endl;
+        return false;
+    }
+    applyRenderOptions(renderer.getConfig(), options);
+    
+    const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "GL startup: " << 1000.0 * seconds << " ms" << std::endl;
+    return true;
+}
+
+static bool renderWithGL(ParticleSystem& particleSystem, const HeadlessOptions& options,
+                         FrameRecorder* recorder, FrameTimings& timings,
+                         std::vector<unsigned char>& pixels) {
+    HeadlessContext context;
+    Renderer renderer;
+    if (!initializeGL(context, renderer, options)) {
+        return false;
+    }
+    renderer.getCamera().setZoom(options.zoom);
+    renderer.getCamera().setCenter(glm::vec2(options.centerX, options.centerY));
+    
+    FrameCapture capture(3, 2, 4);
+    if (recorder && !capture.initialize()) {
+        return false;
+    }
+    
+    // glFinish makes the timing include the actual rasterisation work
+    context.bindFramebuffer();
+    timings = runFrames(particleSystem, options.frames, [&](const ParticleView& view) {
+        renderer.setupFrame();
+        renderer.renderParticles(view, particleSystem.getSpatialHash());
+        renderer.present();
+        
+        uint64_t sequence = 0;
+        if (recorder && recorder->beginFrame(sequence)) {
+            capture.capture(0, 0, options.width, options.height, [recorder, sequence](FrameCapture::Frame& frame) {
+                recorder->submit(sequence, std::move(frame));
+            });
+            capture.poll();
+        }
+        glFinish();
+    });
+    
+    capture.cleanup();
+    context.readPixels(pixels);
+    renderer.cleanup();
+    return true;
+}
+
+// Points vs instanced quads on synthetic particles (no simulation, so a
+// million particles is practical). Every frame re-uploads, as in the app
+static bool runSpriteBenchmark(const HeadlessOptions& options) {
+    HeadlessContext context;
+    Renderer renderer;
+    if (!initializeGL(context, renderer, options)) {
+        return false;
+    }
+    renderer.getConfig().densityMode = false;
+    
+    GLfloat pointSizeRange[2] = {0.0f, 0.0f};
+    glGetFloatv(GL_POINT_SIZE_RANGE, pointSizeRange);
+    std::cout << "Point size range: " << pointSizeRange[0] << " - " << pointSizeRange[1] << std::endl;
+    std::cout << "particles   points ms   quads ms" << std::endl;
+    
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> posDist(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> velDist(-0.01f, 0.01f);
+    std::vector<Particle> particles;
+    
+    context.bindFramebuffer();
+    for (size_t count : {size_t(10000), size_t(100000), size_t(1000000)}) {
+        particles.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            particles[i].x = posDist(rng);
+            particles[i].y = posDist(rng);
+            particles[i].vx = velDist(rng);
+            particles[i].vy = velDist(rng);
+            particles[i].type = static_cast<int>(i % 4);
+        }
+        const ParticleView view(particles);
+        
+        double milliseconds[2] = {0.0, 0.0};
+        for (int mode = 0; mode < 2; ++mode) {
+            renderer.getConfig().instancedQuads = (mode == 1);
+            auto frame = [&]() {
+                renderer.setupFrame();
+                renderer.renderParticles(view);
+                renderer.present();
+                glFinish();
+            };
+            frame(); // Warm-up: buffer allocation and shader compilation
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < options.frames; ++i) {
+                frame();
+            }
+            const double seconds = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            milliseconds[mode] = 1000.0 * seconds / options.frames;
+        }
+        std::cout << std::setw(9) << count << std::setw(12) << milliseconds[0]
+                  << std::setw(11) << milliseconds[1] << std::endl;
+    }
+    
+    renderer.cleanup();
+    return true;
+}
+#endif
+
+static bool renderWithCPU(ParticleSystem& particleSystem, const HeadlessOptions& options,
+                          FrameRecorder* recorder, FrameTimings& timings,
+                          std::vector<unsigned char>& pixels) {
+    SoftwareRenderer renderer;
+    if (!renderer.initialize(options.width, options.height)) {
+        return false;
+    }
+    applyRenderOptions(renderer.getConfig(), options);
+    
+    timings = runFrames(particleSystem, options.frames, [&](const ParticleView& view) {
+        renderer.setupFrame();
+        renderer.renderParticles(view);
+        
+        uint64_t sequence = 0;
+        if (recorder && recorder->beginFrame(sequence)) {
+            FrameCapture::Frame frame;
+            frame.width = renderer.getWidth();
+            frame.height = renderer.getHeight();
+            frame.topDown = true;
+            frame.rgba = renderer.getPixels();
+            recorder->submit(sequence, std::move(frame));
+        }
+    });
+    
+    pixels = renderer.getPixels();
+    return true;
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    
+    if (options.spriteBench) {
+#ifdef PARTICLELIFE_HAS_EGL
+        return runSpriteBenchmark(options) ? 0 : 1;
+#else
+        std::cerr << "--sprite-bench needs the EGL build" << std::endl;
+        return 1;
+#endif
+    }
+    
+    PerfCounters::instance().setEnabled(options.perfCounters);
+    
+    ParticleSystem particleSystem;
+    particleSystem.getConfig().particlesPerType = options.particlesPerType;
+    if (options.seed >= 0) {
+        particleSystem.getConfig().deterministic = true;
+        particleSystem.getConfig().seed = static_cast<uint32_t>(options.seed);
+        if (!options.hashPath.empty()) {
+            hashLog.open(options.hashPath);
+            if (!hashLog) {
+                std::cerr << "Failed to open " << options.hashPath << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (!options.preset.empty()) {
+        particleSystem.loadPreset(options.preset);
+    } else {
+        particleSystem.resetSimulation(true);
+    }
+    
+    using Clock = std::chrono::high_resolution_clock;
+    const float fixedDeltaTime = 1.0f / 60.0f;
+    
+    auto simStart = Clock::now();
+    for (int i = 0; i < options.steps; ++i) {
+        stepSimulation(particleSystem, fixedDeltaTime);
+    }
+    double simSeconds = std::chrono::duration<double>(Clock::now() - simStart).count();
+    
+    std::unique_ptr<FrameRecorder> recorder;
+    if (!options.recordPath.empty()) {
+        FrameRecorder::Config recordConfig;
+        const std::string& path = options.recordPath;
+        const bool y4m = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+        recordConfig.format = y4m ? FrameRecorder::Y4M : FrameRecorder::PNG_SEQUENCE;
+        recordConfig.path = path;
+        recordConfig.captureEvery = options.recordEvery;
+        recorder = std::make_unique<FrameRecorder>(recordConfig);
+        if (!recorder->start()) {
+            return 1;
+        }
+    }
+    
+    FrameTimings timings;
+    std::vector<unsigned char> pixels;
+    bool rendered = false;
+#ifdef PARTICLELIFE_HAS_EGL
+    if (options.renderer == "gl") {
+        rendered = renderWithGL(particleSystem, options, recorder.get(), timings, pixels);
+        if (!rendered) {
+            std::cerr << "GL rendering unavailable, falling back to the CPU renderer" << std::endl;
+            options.renderer = "cpu";
+        }
+    }
+#endif
+    if (!rendered) {
+        if (options.renderer != "cpu") {
+            std::cerr << "Unknown renderer: " << options.renderer << std::endl;
+            return 1;
+        }
+        rendered = renderWithCPU(particleSystem, options, recorder.get(), timings, pixels);
+    }
+    if (!rendered) {
+        return 1;
+    }
+    
+    if (!stbi_write_png(options.output.c_str(), options.width, options.height, 4,
+                        pixels.data(), options.width * 4)) {
+        std::cerr << "Failed to write " << options.output << std::endl;
+    }
+    
+    std::cout << "Renderer: " << options.renderer
+              << "  Particles: " << particleSystem.getParticleCount()
+              << "  Resolution: " << options.width << "x" << options.height << std::endl;
+    if (options.steps > 0) {
+        std::cout << "Simulation: " << options.steps / simSeconds << " steps/s" << std::endl;
+    }
+    std::cout << "Render only: " << options.frames / timings.renderSeconds << " fps ("
+              << 1000.0 * timings.renderSeconds / options.frames << " ms/frame)" << std::endl;
+    std::cout << "Simulate + render: " << options.frames / timings.frameSeconds << " fps" << std::endl;
+    if (particleSystem.getConfig().deterministic) {
+        std::cout << "State hash: " << std::hex << std::setw(16) << std::setfill('0')
+                  << particleSystem.getMetrics().stateHash << std::dec << std::setfill(' ') << std::endl;
+    }
+    printZoneReport(Profiler::instance());
+    printCounterReport();
+    if (!options.tracePath.empty()) {
+        Profiler::instance().saveTrace(options.tracePath);
+        Profiler::instance().waitForTraces();
+    }
+    std::cout << "Wrote " << options.output << std::endl;
+    
+    if (recorder) {
+        recorder->stop();
+        std::cout << "Recorded " << recorder->getFramesWritten() << " frames to "
+                  << options.recordPath << std::endl;
+    }
+    
+    return 0;
+}
@@ -7,17 +7,23 @@
 
 #include "simulation/ParticleSystem.h"
 #include "rendering/Renderer.h"
+#include "rendering/ShaderManager.h"
+#include "rendering/FrameCapture.h"
+#include "rendering/FrameRecorder.h"
+#include "rendering/QualityGovernor.h"
 #include "ui/Interface.h"
+#include "util/FramePacer.h"
+#include "util/Profiler.h"
 
 #include <iostream>
 #include <memory>
 #include <cstdlib>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <filesystem>
 #include <vector>
-#include "stb_image_write.h"
 
 // Application constants
 const int SCREEN_WIDTH = 1400;
@@ -61,39 +67,70 @@ struct AppState {
     std::unique_ptr<ParticleSystem> particleSystem;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Interface> interface;
+    std::unique_ptr<FrameCapture> frameCapture;
+    std::unique_ptr<FrameRecorder> recorder;
+    FramePacer pacer;
+    QualityGovernor governor;
     GLFWwindow* window = nullptr;
+    bool screenshotRequested = false;
+    
+    // Camera drag (Shift + left mouse button)
+    bool panning = false;
+    glm::vec2 lastPanPosition = glm::vec2(0.0f);
 } g_app;
 
+// Converts a cursor position to normalised coordinates of the simulation
+// viewport. Returns false over the side panel.
+static bool cursorToViewport(GLFWwindow* window, double x, double y, glm::vec2& ndc) {
+    float mouseFbX = 0.0f, mouseFbY = 0.0f;
+    getMouseInFramebufferCoords(window, x, y, mouseFbX, mouseFbY);
+
+    int fbW = 0, fbH = 0, viewportW = 0, viewportH = 0;
+    getSizes(window, fbW, fbH, viewportW, viewportH);
+    if (mouseFbX >= static_cast<float>(viewportW)) {
+        return false;
+    }
+
+    ndc.x = (2.0f * mouseFbX) / static_cast<float>(viewportW) - 1.0f;
+    ndc.y = 1.0f - (2.0f * mouseFbY) / static_cast<float>(viewportH);
+    return true;
+}
+
 // Callback functions
 void mouseCallback(GLFWwindow* /*window*/, double x, double y) {
     if (g_app.particleSystem) {
         // Don't let UI interactions affect the simulation.
         ImGuiIO& io = ImGui::GetIO();
-        if (io.WantCaptureMouse) {
+        if (io.WantCaptureMouse && !g_app.panning) {
             return;
         }
 
-        float mouseFbX = 0.0f, mouseFbY = 0.0f;
-        getMouseInFramebufferCoords(g_app.window, x, y, mouseFbX, mouseFbY);
-
         // Only handle mouse input in the simulation viewport (left side)
-        int fbW = 0, fbH = 0, viewportW = 0, viewportH = 0;
-        getSizes(g_app.window, fbW, fbH, viewportW, viewportH);
-
-        if (mouseFbX >= static_cast<float>(viewportW)) {
+        glm::vec2 ndc;
+        if (!cursorToViewport(g_app.window, x, y, ndc)) {
             return; // Ignore mouse in side panel area
         }
         
-        // Convert to viewport coordinates
-        float mouseX = (2.0f * mouseFbX) / static_cast<float>(viewportW) - 1.0f;
-        float mouseY = 1.0f - (2.0f * mouseFbY) / static_cast<float>(viewportH);
-        g_app.particleSystem->setMousePosition(mouseX, mouseY);
+        Camera& camera = g_app.renderer->getCamera();
+        if (g_app.panning) {
+            camera.pan(ndc - g_app.lastPanPosition);
+            g_app.lastPanPosition = ndc;
+        }
+        
+        // Convert to world coordinates through the camera
+        const glm::vec2 world = camera.screenToWorld(ndc);
+        g_app.particleSystem->setMousePosition(world.x, world.y);
     }
 }
 
-void mouseButtonCallback(GLFWwindow* /*window*/, int button, int action, int /*mods*/) {
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     if (!g_app.particleSystem) return;
 
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE && g_app.panning) {
+        g_app.panning = false;
+        return;
+    }
+
     // Don't let UI clicks spawn/affect particles.
     ImGuiIO& io = ImGui::GetIO();
     if (io.WantCaptureMouse) {
@@ -102,7 +139,12 @@ void mouseButtonCallback(GLFWwindow* /*window*/, int button, int action, int /*m
     
     auto& config = g_app.particleSystem->getConfig();
     
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && (mods & GLFW_MOD_SHIFT)) {
+        // Shift + drag pans the camera
+        double x = 0.0, y = 0.0;
+        glfwGetCursorPos(window, &x, &y);
+        g_app.panning = cursorToViewport(window, x, y, g_app.lastPanPosition);
+    } else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         // Note: UI labels indicate mouseMode 0 = spawn, 1 = interact.
         if (config.mouseMode == 0) {
             // Quietly spawn to avoid console spam causing lag
@@ -127,15 +169,24 @@ void mouseButtonCallback(GLFWwindow* /*window*/, int button, int action, int /*m
     }
 }
 
-// Screenshot functionality
-void takeScreenshot(GLFWwindow* window) {
-    // Create screenshots directory if it doesn't exist
-    const char* dir = "screenshots";
-    if (!std::filesystem::exists(dir)) {
-        std::filesystem::create_directories(dir);
+void scrollCallback(GLFWwindow* window, double /*xoffset*/, double yoffset) {
+    if (!g_app.renderer) return;
+
+    ImGuiIO& io = ImGui::GetIO();
+    if (io.WantCaptureMouse) {
+        return;
     }
-    
-    // Generate timestamp for filename
+
+    // Zoom around the cursor so the point under it stays put
+    double x = 0.0, y = 0.0;
+    glfwGetCursorPos(window, &x, &y);
+    glm::vec2 ndc;
+    if (cursorToViewport(window, x, y, ndc)) {
+        g_app.renderer->getCamera().zoomAt(ndc, std::pow(1.15f, static_cast<float>(yoffset)));
+    }
+}
+
+static std::string makeTimestamp() {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
@@ -143,41 +194,88 @@ void takeScreenshot(GLFWwindow* window) {
     std::stringstream ss;
     ss << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S_");
     ss << std::setfill('0') << std::setw(3) << ms.count();
+    return ss.str();
+}
+
+// Screenshot functionality: queues an async readback of the back buffer.
+// Must be called after the frame is drawn and before glfwSwapBuffers.
+void takeScreenshot(GLFWwindow* window) {
+    // Create screenshots directory if it doesn't exist
+    const char* dir = "screenshots";
+    if (!std::filesystem::exists(dir)) {
+        std::filesystem::create_directories(dir);
+    }
     
-    std::string filename = std::string(dir) + "/particle_life_" + ss.str() + ".png";
+    std::string filename = std::string(dir) + "/particle_life_" + makeTimestamp() + ".png";
     
     std::cout << "📸 Taking screenshot..." << std::endl;
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     
-    // Allocate memory for pixels
-    GLsizei nrChannels = 3;
-    GLsizei stride = nrChannels * width;
-    stride += (stride % 4) ? (4 - stride % 4) : 0;
-    GLsizei bufferSize = stride * height;
-    std::vector<char> buffer(bufferSize);
-
-    // Read pixels from the front buffer
-    glPixelStorei(GL_PACK_ALIGNMENT, 4);
-    glReadBuffer(GL_FRONT);
-    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, buffer.data());
-
-    // Flip the image vertically
-    std::vector<char> flipped_buffer(bufferSize);
-    for (int y = 0; y < height; y++) {
-        memcpy(flipped_buffer.data() + y * stride, buffer.data() + (height - 1 - y) * stride, stride);
+    // Readback goes through a PBO; flipping and PNG encoding run on a worker
+    glReadBuffer(GL_BACK);
+    g_app.frameCapture->capture(0, 0, width, height, [filename](FrameCapture::Frame& frame) {
+        if (!frame.empty() && FrameCapture::writePNG(frame, filename)) {
+            std::cout << "📸 Screenshot saved to " << filename << std::endl;
+        } else {
+            std::cout << "❌ Failed to save screenshot." << std::endl;
+        }
+    });
+}
+
+// Profiler timeline as Chrome trace JSON: the frames already profiled, or
+// (Shift+T) the ones about to be. Written on a background thread
+void saveTrace(bool nextFrames) {
+    Profiler& profiler = Profiler::instance();
+    if (!profiler.isEnabled()) {
+        std::cout << "Zone profiler is off; enable it in the Performance HUD to trace" << std::endl;
+        return;
+    }
+    
+    const char* dir = "traces";
+    if (!std::filesystem::exists(dir)) {
+        std::filesystem::create_directories(dir);
     }
+    const std::string filename = std::string(dir) + "/particle_life_" + makeTimestamp() + ".json";
+    
+    if (nextFrames) {
+        profiler.traceNextFrames(filename, Profiler::TRACE_FRAMES);
+        std::cout << "Tracing the next " << Profiler::TRACE_FRAMES << " frames to " << filename << std::endl;
+    } else if (!profiler.saveTrace(filename)) {
+        std::cout << "No profiled frames to trace yet" << std::endl;
+    }
+}
 
-    // Save the image using stb_image_write
-    if (stbi_write_png(filename.c_str(), width, height, nrChannels, flipped_buffer.data(), stride)) {
-        std::cout << "📸 Screenshot saved to " << filename << std::endl;
-    } else {
-        std::cout << "❌ Failed to save screenshot." << std::endl;
+// Video recording: every frame of the simulation viewport goes to a Y4M file
+void toggleRecording() {
+    if (g_app.recorder && g_app.recorder->isRecording()) {
+        // Land in-flight readbacks before the encoders are drained
+        g_app.frameCapture->flush();
+        g_app.recorder->stop();
+        std::cout << "🎬 Recording stopped: " << g_app.recorder->getFramesWritten()
+                  << " frames written to " << g_app.recorder->getConfig().path;
+        if (g_app.recorder->getFramesDropped() > 0) {
+            std::cout << " (" << g_app.recorder->getFramesDropped() << " dropped)";
+        }
+        std::cout << std::endl;
+        g_app.recorder.reset();
+        return;
+    }
+    
+    FrameRecorder::Config config;
+    config.format = FrameRecorder::Y4M;
+    config.path = "recordings/particle_life_" + makeTimestamp() + ".y4m";
+    
+    g_app.recorder = std::make_unique<FrameRecorder>(config);
+    if (!g_app.recorder->start()) {
+        g_app.recorder.reset();
+        return;
     }
+    std::cout << "🎬 Recording to " << config.path << " (press V to stop)" << std::endl;
 }
 
-void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/) {
+void keyCallback(GLFWwindow* /*window*/, int key, int /*scancode*/, int action, int mods) {
     if (action == GLFW_PRESS && g_app.particleSystem) {
         ImGuiIO& io = ImGui::GetIO();
         if (io.WantCaptureKeyboard) {
@@ -194,7 +292,13 @@ void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int
             std::cout << "🔄 Simulation reset" << std::endl;
         } else if (key == GLFW_KEY_S) {
             std::cout << "📸 S key pressed - taking screenshot..." << std::endl;
-            takeScreenshot(window);
+            g_app.screenshotRequested = true; // Captured at the end of the next frame
+        } else if (key == GLFW_KEY_V) {
+            toggleRecording();
+        } else if (key == GLFW_KEY_T) {
+            saveTrace((mods & GLFW_MOD_SHIFT) != 0);
+        } else if (key == GLFW_KEY_C && g_app.renderer) {
+            g_app.renderer->getCamera().reset();
         }
     }
 }
@@ -222,8 +326,8 @@ bool initializeOpenGL() {
     
     glfwMakeContextCurrent(g_app.window);
     
-    // Enable VSync for smoother rendering
-    glfwSwapInterval(1);
+    // Swap interval follows the pacing mode (VSync by default)
+    glfwSwapInterval(g_app.pacer.usesVsync() ? 1 : 0);
     
     // Initialize GLAD
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -232,10 +336,14 @@ bool initializeOpenGL() {
         return false;
     }
     
+    // Reuse linked shader programs across launches when the driver allows it
+    ShaderManager::enableBinaryCache((GLADloadproc)glfwGetProcAddress, "shader_cache");
+    
     // Set callbacks
     glfwSetCursorPosCallback(g_app.window, mouseCallback);
     glfwSetMouseButtonCallback(g_app.window, mouseButtonCallback);
     glfwSetKeyCallback(g_app.window, keyCallback);
+    glfwSetScrollCallback(g_app.window, scrollCallback);
     
     return true;
 }
@@ -352,12 +460,22 @@ bool initializeApplication() {
     g_app.particleSystem = std::make_unique<ParticleSystem>();
     g_app.renderer = std::make_unique<Renderer>();
     g_app.interface = std::make_unique<Interface>(*g_app.particleSystem, *g_app.renderer);
+    g_app.interface->setFramePacer(&g_app.pacer);
+    g_app.interface->setQualityGovernor(&g_app.governor);
     
     // Initialize components
     if (!g_app.renderer->initialize()) {
         std::cerr << "Failed to initialize renderer" << std::endl;
         return false;
     }
+    g_app.renderer->setShaderHotReload(true);
+    
+    // Bounded encoder queue: a slow disk throttles the main loop during recording
+    g_app.frameCapture = std::make_unique<FrameCapture>(3, 2, 4);
+    if (!g_app.frameCapture->initialize()) {
+        std::cerr << "Failed to initialize frame capture" << std::endl;
+        return false;
+    }
     
     if (!g_app.interface->initialize()) {
         std::cerr << "Failed to initialize interface" << std::endl;
@@ -369,6 +487,7 @@ bool initializeApplication() {
     std::cout << "  SPACE - Pause/Resume" << std::endl;
     std::cout << "  R - Randomize forces" << std::endl;
     std::cout << "  S - Take screenshot" << std::endl;
+    std::cout << "  V - Start/stop video recording (Y4M)" << std::endl;
     std::cout << "  Left Click + Drag - Repel particles" << std::endl;
     std::cout << "  Right Click - Spawn particles" << std::endl;
     std::cout << "  Middle Click - Remove particles" << std::endl;
@@ -393,6 +512,15 @@ bool initializeApplication() {
 }
 
 void cleanup() {
+    // Finish pending captures while the GL context is still alive
+    if (g_app.recorder && g_app.recorder->isRecording()) {
+        toggleRecording();
+    }
+    if (g_app.frameCapture) {
+        g_app.frameCapture->cleanup();
+        g_app.frameCapture.reset();
+    }
+    
     // Cleanup application components
     if (g_app.interface) {
         g_app.interface->cleanup();
@@ -405,6 +533,7 @@ void cleanup() {
     }
     
     g_app.particleSystem.reset();
+    Profiler::instance().waitForTraces();
     
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
@@ -424,35 +553,42 @@ int main() {
         return -1;
     }
     
-    // Timestep management
-    double lastTime = glfwGetTime();
-    double accumulator = 0.0;
-    const double fixedDeltaTime = 1.0 / 60.0; // 60 Hz physics update rate (matches target frame rate)
-    const double maxFrameTime = 0.25; // Cap at 250ms (4 FPS minimum) to prevent spiral of death
+    FramePacer& pacer = g_app.pacer;
+    bool vsync = pacer.usesVsync();
+    double updateMs = 0.0; // Simulation time since the last rendered frame
 
     // Main application loop
     while (!glfwWindowShouldClose(g_app.window)) {
-        double currentTime = glfwGetTime();
-        double frameTime = currentTime - lastTime;
-        lastTime = currentTime;
+        // Every iteration, including the step-only ones that skip rendering,
+        // so input and the mouse force keep up with the simulation
+        glfwPollEvents();
         
-        // Clamp frame time to prevent spiral of death
-        if (frameTime > maxFrameTime) {
-            frameTime = maxFrameTime;
+        if (pacer.usesVsync() != vsync) {
+            vsync = pacer.usesVsync();
+            glfwSwapInterval(vsync ? 1 : 0);
         }
         
-        accumulator += frameTime;
-
-        // Limit accumulator to prevent catching up too much
-        if (accumulator > maxFrameTime) {
-            accumulator = maxFrameTime;
-        }
-
-        // Update simulation with a fixed timestep
-        while (accumulator >= fixedDeltaTime) {
-            g_app.particleSystem->update(fixedDeltaTime);
-            accumulator -= fixedDeltaTime;
+        const int steps = pacer.beginFrame(glfwGetTime());
+        const bool recording = g_app.recorder && g_app.recorder->isRecording();
+        if (recording) {
+            // Exactly one fixed step per recorded frame, independent of
+            // wall-clock time, so recordings are reproducible
+            g_app.particleSystem->update(static_cast<float>(pacer.getStepDelta()));
+            updateMs += g_app.particleSystem->getMetrics().updateTimeMs;
+            pacer.resetAccumulator();
+        } else {
+            for (int i = 0; i < steps; ++i) {
+                g_app.particleSystem->update(static_cast<float>(pacer.getStepDelta()));
+                updateMs += g_app.particleSystem->getMetrics().updateTimeMs;
+            }
+            
+            // Keep stepping until the next frame is due (unless paused,
+            // where there is nothing to step)
+            if (!g_app.particleSystem->getConfig().paused && !pacer.shouldRender(glfwGetTime())) {
+                continue;
+            }
         }
+        const double renderStart = glfwGetTime();
 
         // Use the actual framebuffer size (windowed mode + HiDPI safe).
         int fbW = 0, fbH = 0, viewportW = 0, viewportH = 0;
@@ -470,18 +606,51 @@ int main() {
         
         // Render frame (setupFrame will clear again with trails logic)
         g_app.renderer->setupFrame();
-        g_app.renderer->renderParticles(g_app.particleSystem->getParticles());
+        // Recorded frames show exactly the stepped state
+        g_app.renderer->renderParticles(g_app.particleSystem->getParticleView(),
+                                        g_app.particleSystem->getSpatialHash(),
+                                        recording ? 1.0f : pacer.getInterpolationAlpha());
+        g_app.renderer->present();
+        const double sceneEnd = glfwGetTime();
+        
+        // Record the simulation viewport before the UI is drawn over the frame
+        uint64_t sequence = 0;
+        if (recording && g_app.recorder->beginFrame(sequence)) {
+            FrameRecorder* recorder = g_app.recorder.get();
+            glReadBuffer(GL_BACK);
+            g_app.frameCapture->capture(0, 0, viewportW, viewportH, [recorder, sequence](FrameCapture::Frame& frame) {
+                recorder->submit(sequence, std::move(frame));
+            });
+        }
         
         // Disable scissor and reset viewport for UI
         glDisable(GL_SCISSOR_TEST);
         glViewport(0, 0, fbW, fbH);
         
         // Render UI
-        g_app.interface->render();
+        {
+            Profiler::Scope zone(Profiler::UI);
+            g_app.interface->render();
+        }
+        
+        // Queue captures before the back buffer is swapped away, then hand
+        // any readbacks that have landed to the encoder workers
+        if (g_app.screenshotRequested) {
+            takeScreenshot(g_app.window);
+            g_app.screenshotRequested = false;
+        }
+        g_app.frameCapture->poll();
+        const double frameEnd = glfwGetTime();
+        pacer.frameRendered(renderStart, static_cast<float>(1000.0 * (frameEnd - renderStart)));
+        g_app.governor.recordFrame(frameEnd, static_cast<float>(updateMs),
+                                   static_cast<float>(1000.0 * (sceneEnd - renderStart)),
+                                   static_cast<float>(1000.0 * (frameEnd - sceneEnd)),
+                                   g_app.renderer->getConfig(), pacer.getConfig());
+        updateMs = 0.0;
+        Profiler::instance().endFrame();
         
         // Present frame
         glfwSwapBuffers(g_app.window);
-        glfwPollEvents();
     }
     
     cleanup();
@@ -0,0 +1,156 @@
+#include "rendering/FrameCapture.h"
+#include "stb_image_write.h"
+#include <iostream>
+#include <cstring>
+#include <memory>
+
+FrameCapture::FrameCapture(int ringSize, int workerThreads, size_t maxQueuedFrames)
+    : slots(ringSize > 0 ? ringSize : 1), nextSlot(0), captureCount(0),
+      workers(workerThreads, maxQueuedFrames) {
+}
+
+FrameCapture::~FrameCapture() {
+    cleanup();
+}
+
+bool FrameCapture::initialize() {
+    for (auto& slot : slots) {
+        glGenBuffers(1, &slot.pbo);
+        if (slot.pbo == 0) {
+            std::cerr << "Failed to create pixel pack buffer" << std::endl;
+            cleanup();
+            return false;
+        }
+    }
+    return true;
+}
+
+void FrameCapture::cleanup() {
+    flush();
+    for (auto& slot : slots) {
+        if (slot.pbo != 0) {
+            glDeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+        }
+    }
+}
+
+void FrameCapture::capture(int x, int y, int width, int height, FrameHandler handler) {
+    Slot& slot = slots[nextSlot];
+    if (slot.pbo == 0 || width <= 0 || height <= 0) {
+        // Nothing to read (e.g. a minimised window); the handler still runs so
+        // sequenced consumers can account for the frame
+        auto frame = std::make_shared<Frame>();
+        frame->index = captureCount++;
+        dispatch(frame, std::move(handler));
+        return;
+    }
+    
+    // Ring full: the oldest readback must complete before its PBO is reused
+    if (slot.fence) {
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        retire(slot);
+    }
+    
+    const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.index = captureCount++;
+    slot.handler = std::move(handler);
+    
+    nextSlot = (nextSlot + 1) % slots.size();
+}
+
+void FrameCapture::retire(Slot& slot) {
+    auto frame = std::make_shared<Frame>();
+    frame->width = slot.width;
+    frame->height = slot.height;
+    frame->index = slot.index;
+    frame->rgba.resize(static_cast<size_t>(slot.width) * slot.height * 4);
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame->rgba.size(), GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(frame->rgba.data(), mapped, frame->rgba.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cerr << "Failed to map readback of frame " << slot.index << std::endl;
+        frame->width = frame->height = 0;
+        frame->rgba.clear();
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    
+    dispatch(frame, std::move(slot.handler));
+    slot.handler = nullptr;
+}
+
+void FrameCapture::dispatch(std::shared_ptr<Frame> frame, FrameHandler handler) {
+    if (!handler) return;
+    workers.submit([frame, handler]() { handler(*frame); });
+}
+
+void FrameCapture::poll() {
+    // Retire in capture order so handlers see frames sequentially
+    for (size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[(nextSlot + i) % slots.size()];
+        if (!slot.fence) continue;
+        
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        retire(slot);
+    }
+}
+
+void FrameCapture::flush() {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[(nextSlot + i) % slots.size()];
+        if (!slot.fence) continue;
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        retire(slot);
+    }
+    workers.waitIdle();
+}
+
+size_t FrameCapture::inFlight() const {
+    size_t count = 0;
+    for (const auto& slot : slots) {
+        if (slot.fence) count++;
+    }
+    return count;
+}
+
+void FrameCapture::toTopDownRGB(const Frame& frame, std::vector<unsigned char>& rgb) {
+    const size_t srcStride = static_cast<size_t>(frame.width) * 4;
+    const size_t dstStride = static_cast<size_t>(frame.width) * 3;
+    rgb.resize(dstStride * frame.height);
+    
+    for (int y = 0; y < frame.height; ++y) {
+        const int srcRow = frame.topDown ? y : frame.height - 1 - y;
+        const unsigned char* src = frame.rgba.data() + srcRow * srcStride;
+        unsigned char* dst = rgb.data() + y * dstStride;
+        for (int x = 0; x < frame.width; ++x) {
+            dst[x * 3 + 0] = src[x * 4 + 0];
+            dst[x * 3 + 1] = src[x * 4 + 1];
+            dst[x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+}
+
+bool FrameCapture::writePNG(const Frame& frame, const std::string& filename) {
+    // Alpha is dropped: the back buffer's alpha depends on blend state
+    std::vector<unsigned char> rgb;
+    toTopDownRGB(frame, rgb);
+    return stbi_write_png(filename.c_str(), frame.width, frame.height, 3, rgb.data(), frame.width * 3) != 0;
+}
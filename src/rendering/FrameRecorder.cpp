@@ -0,0 +1,217 @@
+#include "rendering/FrameRecorder.h"
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+FrameRecorder::FrameRecorder(const Config& cfg)
+    : config(cfg), encoders(cfg.encoderThreads, cfg.maxQueuedFrames),
+      recording(false), frameCounter(0), nextSequence(0),
+      y4mFile(nullptr), y4mWidth(0), y4mHeight(0), nextToWrite(0), framesWritten(0), framesDropped(0) {
+    config.captureEvery = std::max(config.captureEvery, 1);
+    config.maxReorderFrames = std::max<size_t>(config.maxReorderFrames, 1);
+}
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+bool FrameRecorder::start() {
+    if (recording) return true;
+    
+    if (config.format == PNG_SEQUENCE) {
+        std::error_code ec;
+        std::filesystem::create_directories(config.path, ec);
+        if (ec) {
+            std::cerr << "Failed to create recording directory " << config.path << std::endl;
+            return false;
+        }
+    } else {
+        const auto parent = std::filesystem::path(config.path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent);
+        }
+        y4mFile = std::fopen(config.path.c_str(), "wb");
+        if (!y4mFile) {
+            std::cerr << "Failed to open " << config.path << " for writing" << std::endl;
+            return false;
+        }
+    }
+    
+    frameCounter = 0;
+    nextSequence = 0;
+    nextToWrite = 0;
+    framesWritten = 0;
+    framesDropped = 0;
+    y4mWidth = y4mHeight = 0;
+    recording = true;
+    return true;
+}
+
+void FrameRecorder::stop() {
+    if (!recording) return;
+    recording = false;
+    
+    encoders.waitIdle();
+    
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!pendingWrites.empty()) {
+        // Only reachable when a sequence was never submitted
+        std::cerr << "Recording stopped with " << pendingWrites.size()
+                  << " frames waiting for an earlier one" << std::endl;
+        framesDropped += pendingWrites.size();
+        pendingWrites.clear();
+    }
+    if (framesDropped > 0) {
+        std::cerr << "Recording dropped " << framesDropped << " frames" << std::endl;
+    }
+    if (y4mFile) {
+        std::fclose(y4mFile);
+        y4mFile = nullptr;
+    }
+}
+
+bool FrameRecorder::beginFrame(uint64_t& sequence) {
+    if (!recording) return false;
+    
+    const bool capture = (frameCounter++ % config.captureEvery) == 0;
+    if (capture) {
+        sequence = nextSequence++;
+    }
+    return capture;
+}
+
+void FrameRecorder::submit(uint64_t sequence, FrameCapture::Frame&& frame) {
+    auto shared = std::make_shared<FrameCapture::Frame>(std::move(frame));
+    encoders.submit([this, sequence, shared]() {
+        if (config.format == PNG_SEQUENCE) {
+            encodePNG(sequence, *shared);
+        } else {
+            encodeY4M(sequence, *shared);
+        }
+    });
+}
+
+uint64_t FrameRecorder::getFramesWritten() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return framesWritten;
+}
+
+uint64_t FrameRecorder::getFramesDropped() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return framesDropped;
+}
+
+void FrameRecorder::encodePNG(uint64_t sequence, const FrameCapture::Frame& frame) {
+    if (frame.empty()) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        framesDropped++;
+        return;
+    }
+    
+    std::ostringstream name;
+    name << config.path << "/frame_" << std::setfill('0') << std::setw(6) << sequence << ".png";
+    
+    const bool written = FrameCapture::writePNG(frame, name.str());
+    if (!written) {
+        std::cerr << "Failed to write " << name.str() << std::endl;
+    }
+    
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (written) {
+        framesWritten++;
+    } else {
+        framesDropped++;
+    }
+}
+
+void FrameRecorder::encodeY4M(uint64_t sequence, const FrameCapture::Frame& frame) {
+    // 4:2:0 needs even dimensions; drop the odd row/column
+    const int w = frame.width & ~1;
+    const int h = frame.height & ~1;
+    if (w <= 0 || h <= 0) {
+        // Nothing to encode, but later frames must not wait for this one
+        writeInOrder(sequence, 0, 0, {});
+        return;
+    }
+    
+    std::vector<unsigned char> rgb;
+    FrameCapture::toTopDownRGB(frame, rgb);
+    const size_t rgbStride = static_cast<size_t>(frame.width) * 3;
+    
+    // BT.601 limited-range conversion, chroma averaged over 2x2 blocks
+    std::vector<unsigned char> yuv(static_cast<size_t>(w) * h * 3 / 2);
+    unsigned char* yPlane = yuv.data();
+    unsigned char* uPlane = yPlane + static_cast<size_t>(w) * h;
+    unsigned char* vPlane = uPlane + static_cast<size_t>(w / 2) * (h / 2);
+    
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* row = rgb.data() + y * rgbStride;
+        for (int x = 0; x < w; ++x) {
+            const int r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+            yPlane[y * w + x] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int y = 0; y < h / 2; ++y) {
+        const unsigned char* row0 = rgb.data() + (2 * y) * rgbStride;
+        const unsigned char* row1 = row0 + rgbStride;
+        for (int x = 0; x < w / 2; ++x) {
+            const int i = x * 6;
+            const int r = (row0[i] + row0[i + 3] + row1[i] + row1[i + 3] + 2) >> 2;
+            const int g = (row0[i + 1] + row0[i + 4] + row1[i + 1] + row1[i + 4] + 2) >> 2;
+            const int b = (row0[i + 2] + row0[i + 5] + row1[i + 2] + row1[i + 5] + 2) >> 2;
+            uPlane[y * (w / 2) + x] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[y * (w / 2) + x] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+    
+    writeInOrder(sequence, w, h, std::move(yuv));
+}
+
+void FrameRecorder::writeInOrder(uint64_t sequence, int width, int height, std::vector<unsigned char>&& yuv) {
+    // Whoever completes the next frame in sequence writes every consecutive
+    // frame that is ready, so encoders never wait on each other
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (!y4mFile) return;
+    if (sequence < nextToWrite) {
+        framesDropped++; // Arrived after the reorder buffer gave up on it
+        return;
+    }
+    
+    if (yuv.empty()) {
+        // Skipped upstream; stored anyway so the sequence keeps moving
+    } else if (y4mWidth == 0) {
+        y4mWidth = width;
+        y4mHeight = height;
+        std::fprintf(y4mFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, config.frameRate);
+    } else if (width != y4mWidth || height != y4mHeight) {
+        // Y4M has a fixed frame size; skip resized frames but keep the sequence moving
+        std::cerr << "Skipping frame " << sequence << ": size changed during recording" << std::endl;
+        yuv.clear();
+    }
+    pendingWrites[sequence] = std::move(yuv);
+    
+    // Bounded reorder buffer: rather than hold every later frame for one that
+    // is not coming, count the gap as dropped and carry on from what is here
+    if (pendingWrites.size() > config.maxReorderFrames) {
+        const uint64_t oldest = pendingWrites.begin()->first;
+        std::cerr << "Recording gave up on frames " << nextToWrite << "-" << oldest - 1 << std::endl;
+        framesDropped += oldest - nextToWrite;
+        nextToWrite = oldest;
+    }
+    
+    for (auto it = pendingWrites.find(nextToWrite); it != pendingWrites.end();
+         it = pendingWrites.find(nextToWrite)) {
+        if (!it->second.empty()) {
+            std::fputs("FRAME\n", y4mFile);
+            std::fwrite(it->second.data(), 1, it->second.size(), y4mFile);
+            framesWritten++;
+        } else {
+            framesDropped++;
+        }
+        pendingWrites.erase(it);
+        nextToWrite++;
+    }
+}
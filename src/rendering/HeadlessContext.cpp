@@ -0,0 +1,184 @@
+#include "rendering/HeadlessContext.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+#include <cstring>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    const size_t len = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + len, name)) {
+        if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE),
+      fbo(0), colorBuffer(0), width(0), height(0) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    cleanup();
+}
+
+bool HeadlessContext::initialize(int w, int h) {
+    width = w;
+    height = h;
+    
+    // Prefer the surfaceless platform: no X11/Wayland or GPU needed
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (dpy == EGL_NO_DISPLAY) {
+        dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    
+    EGLint major = 0, minor = 0;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+    display = dpy;
+    
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL implementation has no desktop OpenGL support" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    const bool surfaceless = hasExtension(eglQueryString(dpy, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(dpy, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        std::cerr << "No suitable EGL config found" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(dpy, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create OpenGL 3.3 core context" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    if (!surfaceless) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(dpy, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            std::cerr << "Failed to create EGL pbuffer surface" << std::endl;
+            cleanup();
+            return false;
+        }
+    }
+    
+    if (!eglMakeCurrent(dpy, surface, surface, context)) {
+        std::cerr << "Failed to make EGL context current" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    // All rendering goes to an FBO; the (possibly absent) surface is never drawn
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        cleanup();
+        return false;
+    }
+    
+    std::cout << "Headless context: EGL " << major << "." << minor
+              << (surfaceless ? " (surfaceless)" : " (pbuffer)") << ", "
+              << glGetString(GL_RENDERER) << std::endl;
+    return true;
+}
+
+void HeadlessContext::cleanup() {
+    if (context != EGL_NO_CONTEXT) {
+        if (fbo != 0) {
+            glDeleteFramebuffers(1, &fbo);
+            fbo = 0;
+        }
+        if (colorBuffer != 0) {
+            glDeleteRenderbuffers(1, &colorBuffer);
+            colorBuffer = 0;
+        }
+    }
+    if (display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) {
+            eglDestroyContext(display, context);
+            context = EGL_NO_CONTEXT;
+        }
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+            surface = EGL_NO_SURFACE;
+        }
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+}
+
+GLADloadproc HeadlessContext::getProcLoader() {
+    return (GLADloadproc)eglGetProcAddress;
+}
+
+void HeadlessContext::bindFramebuffer() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+}
+
+void HeadlessContext::readPixels(std::vector<unsigned char>& rgba) const {
+    const size_t stride = static_cast<size_t>(width) * 4;
+    std::vector<unsigned char> raw(stride * height);
+    
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, raw.data());
+    
+    // GL rows are bottom-up; image files are top-down
+    rgba.resize(raw.size());
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(rgba.data() + y * stride, raw.data() + (height - 1 - y) * stride, stride);
+    }
+}
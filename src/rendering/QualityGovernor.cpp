@@ -0,0 +1,213 @@
+#include "rendering/QualityGovernor.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+// A restore undone within this long is treated as oscillation
+static constexpr double OSCILLATION_SECONDS = 5.0;
+static constexpr int MAX_RESTORE_BACKOFF = 8;
+
+QualityGovernor::QualityGovernor()
+    : renderLevel(0), simLevel(0),
+      baseHalfResolutionTrails(false), baseRenderStride(1), baseDensityMode(false), baseStepRate(60.0f),
+      windowStart(0.0), cooldownUntil(0.0), frames(0), updateSum(0.0), renderSum(0.0), uiSum(0.0),
+      goodWindows(0), restoreBackoff(1), lastRestoreTime(-OSCILLATION_SECONDS),
+      started(false), atFloorLogged(false), trailsEnabled(false) {
+}
+
+void QualityGovernor::renderSettings(int level, bool& halfResolutionTrails, int& stride, bool& density) const {
+    halfResolutionTrails = baseHalfResolutionTrails || level >= 1;
+    stride = std::max(baseRenderStride, level >= 3 ? 4 : level >= 2 ? 2 : 1);
+    density = baseDensityMode || level >= 4;
+}
+
+void QualityGovernor::applyRenderLevel(Renderer::Config& render) const {
+    renderSettings(renderLevel, render.halfResolutionTrails, render.renderStride, render.densityMode);
+}
+
+void QualityGovernor::applySimLevel(FramePacer::Config& pacing) const {
+    pacing.stepRate = simLevel == 0 ? baseStepRate
+                                    : std::max(MIN_STEP_RATE, baseStepRate / static_cast<float>(1 << simLevel));
+}
+
+int QualityGovernor::nextRenderLevel() const {
+    bool halfRes, density;
+    int stride;
+    renderSettings(renderLevel, halfRes, stride, density);
+    
+    for (int level = renderLevel + 1; level <= MAX_RENDER_LEVEL; ++level) {
+        bool nextHalfRes, nextDensity;
+        int nextStride;
+        renderSettings(level, nextHalfRes, nextStride, nextDensity);
+        // Half-resolution trails only save anything while trails are drawn
+        const bool halfResChanged = nextHalfRes != halfRes && trailsEnabled;
+        if (halfResChanged || nextStride != stride || nextDensity != density) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+bool QualityGovernor::canLowerSim(const FramePacer::Config& pacing) const {
+    // Only interpolated rendering hides a lower step rate
+    if (pacing.mode != FramePacer::FIXED_INTERPOLATED || simLevel >= MAX_SIM_LEVEL) return false;
+    return simLevel > 0 || pacing.stepRate > MIN_STEP_RATE;
+}
+
+std::string QualityGovernor::describe(Ladder ladder) const {
+    std::ostringstream text;
+    if (ladder == SIM_LADDER) {
+        const float rate = simLevel == 0 ? baseStepRate
+                                         : std::max(MIN_STEP_RATE, baseStepRate / static_cast<float>(1 << simLevel));
+        text << "sim level " << simLevel << " (" << rate << " Hz steps)";
+        return text.str();
+    }
+    
+    static const char* const names[MAX_RENDER_LEVEL + 1] = {
+        "full quality", "half-resolution trails", "draw 1/2 of particles",
+        "draw 1/4 of particles", "density heatmap"
+    };
+    text << "render level " << renderLevel << " (" << names[renderLevel] << ")";
+    return text.str();
+}
+
+void QualityGovernor::recordFrame(double now, float updateMs, float renderMs, float uiMs,
+                                  Renderer::Config& render, FramePacer::Config& pacing) {
+    if (!config.enabled) {
+        if (!history.empty()) {
+            restoreAll(render, pacing);
+        }
+        started = false;
+        return;
+    }
+    
+    if (!started) {
+        windowStart = now;
+        frames = 0;
+        updateSum = renderSum = uiSum = 0.0;
+        started = true;
+    }
+    trailsEnabled = render.enableTrails;
+    updateSum += updateMs;
+    renderSum += renderMs;
+    uiSum += uiMs;
+    ++frames;
+    
+    if (now - windowStart >= config.windowSeconds) {
+        evaluate(now, render, pacing);
+        windowStart = now;
+        frames = 0;
+        updateSum = renderSum = uiSum = 0.0;
+    }
+}
+
+void QualityGovernor::evaluate(double now, Renderer::Config& render, FramePacer::Config& pacing) {
+    if (frames == 0 || now < cooldownUntil) return;
+    
+    const double update = updateSum / frames;
+    const double renderTime = renderSum / frames;
+    const double ui = uiSum / frames;
+    const double total = update + renderTime + ui;
+    
+    std::ostringstream timing;
+    timing.precision(3);
+    timing << total << " ms (update " << update << ", render " << renderTime << ", ui " << ui << ")";
+    
+    if (total > config.budgetMs * config.degradeRatio) {
+        goodWindows = 0;
+        
+        // Lower the ladder of the phase that costs most; UI time has no knob
+        // and only counts towards the total
+        const int nextRender = nextRenderLevel();
+        const bool simCandidate = canLowerSim(pacing);
+        Ladder ladder;
+        if (simCandidate && (update > renderTime || nextRender < 0)) {
+            ladder = SIM_LADDER;
+        } else if (nextRender >= 0) {
+            ladder = RENDER_LADDER;
+        } else {
+            if (!atFloorLogged) {
+                lastDecision = timing.str() + " over budget, already at the lowest quality";
+                std::cout << "Quality governor: " << lastDecision << std::endl;
+                atFloorLogged = true;
+            }
+            return;
+        }
+        
+        if (now - lastRestoreTime < OSCILLATION_SECONDS) {
+            restoreBackoff = std::min(restoreBackoff * 2, MAX_RESTORE_BACKOFF);
+        }
+        
+        if (ladder == SIM_LADDER) {
+            if (simLevel == 0) baseStepRate = pacing.stepRate;
+            history.push_back({SIM_LADDER, simLevel});
+            ++simLevel;
+            applySimLevel(pacing);
+        } else {
+            if (renderLevel == 0) {
+                baseHalfResolutionTrails = render.halfResolutionTrails;
+                baseRenderStride = render.renderStride;
+                baseDensityMode = render.densityMode;
+            }
+            history.push_back({RENDER_LADDER, renderLevel});
+            renderLevel = nextRender;
+            applyRenderLevel(render);
+        }
+        
+        std::ostringstream decision;
+        decision << timing.str() << " over " << config.budgetMs << " ms budget -> " << describe(ladder);
+        lastDecision = decision.str();
+        std::cout << "Quality governor: " << lastDecision << std::endl;
+        cooldownUntil = now + config.cooldownSeconds;
+        return;
+    }
+    
+    atFloorLogged = false;
+    if (total < config.budgetMs * config.restoreRatio && !history.empty()) {
+        if (++goodWindows < config.restoreWindows * restoreBackoff) return;
+        
+        const Change change = history.back();
+        history.pop_back();
+        if (change.ladder == SIM_LADDER) {
+            simLevel = change.previousLevel;
+            applySimLevel(pacing);
+        } else {
+            renderLevel = change.previousLevel;
+            applyRenderLevel(render);
+        }
+        
+        std::ostringstream decision;
+        decision << timing.str() << " under " << config.budgetMs * config.restoreRatio
+                 << " ms -> " << describe(change.ladder);
+        lastDecision = decision.str();
+        std::cout << "Quality governor: " << lastDecision << std::endl;
+        
+        goodWindows = 0;
+        lastRestoreTime = now;
+        cooldownUntil = now + config.cooldownSeconds;
+        return;
+    }
+    goodWindows = 0;
+    
+    // A long stable stretch forgives earlier oscillation
+    if (now - lastRestoreTime > 10.0 * OSCILLATION_SECONDS) {
+        restoreBackoff = 1;
+    }
+}
+
+void QualityGovernor::restoreAll(Renderer::Config& render, FramePacer::Config& pacing) {
+    if (renderLevel > 0) {
+        renderLevel = 0;
+        applyRenderLevel(render);
+    }
+    if (simLevel > 0) {
+        simLevel = 0;
+        applySimLevel(pacing);
+    }
+    history.clear();
+    goodWindows = 0;
+    restoreBackoff = 1;
+    
+    lastDecision = "restored all settings";
+    std::cout << "Quality governor: " << lastDecision << std::endl;
+}
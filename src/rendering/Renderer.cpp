@@ -1,12 +1,24 @@
 #include "rendering/Renderer.h"
 #include "rendering/ShaderManager.h"
+#include "simulation/SpatialHash.h"
+#include "util/FileWatcher.h"
+#include "util/Profiler.h"
 #include <iostream>
+#include <filesystem>
 #include <memory>
 #include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
 
-Renderer::Renderer() : VAO(0), VBO(0), shaderManager(nullptr) {
-    // Initialize color palette
-    colors = {
+std::vector<glm::vec3> Renderer::defaultPalette() {
+    return {
         {1.0f, 0.2f, 0.2f},  // Red
         {0.2f, 1.0f, 0.3f},  // Green
         {0.3f, 0.5f, 1.0f},  // Blue
@@ -18,20 +30,38 @@ Renderer::Renderer() : VAO(0), VBO(0), shaderManager(nullptr) {
     };
 }
 
-Renderer::Renderer(ShaderManager& shaderMgr) : VAO(0), VBO(0), shaderManager(&shaderMgr) {
-    // Initialize color palette
-    colors = {
+std::vector<glm::vec3> Renderer::defaultSpeedGradient() {
+    return {
+        {0.2f, 0.2f, 1.0f},  // Blue
+        {0.2f, 1.0f, 1.0f},  // Cyan
+        {0.2f, 1.0f, 0.2f},  // Green
+        {1.0f, 1.0f, 0.2f},  // Yellow
         {1.0f, 0.2f, 0.2f},  // Red
-        {0.2f, 1.0f, 0.3f},  // Green
-        {0.3f, 0.5f, 1.0f},  // Blue
-        {1.0f, 0.9f, 0.2f},  // Yellow
-        {1.0f, 0.3f, 0.8f},  // Pink
-        {0.3f, 1.0f, 1.0f},  // Cyan
-        {1.0f, 0.6f, 0.2f},  // Orange
-        {0.7f, 0.3f, 1.0f},  // Purple
     };
 }
 
+Renderer::Renderer()
+    : VAO(0), VBO(0), directVAO(0), streamVBOs{0, 0, 0, 0}, shaderManager(nullptr),
+      colors(defaultPalette()), speedGradient(defaultSpeedGradient()),
+      screenVAO(0), trailFBOs{0, 0}, trailTextures{0, 0}, trailWidth(0), trailHeight(0),
+      trailIndex(0), trailsActive(false), trailsValid(false), targetFramebuffer(0),
+      targetViewport{0, 0, 0, 0}, targetScissor(false),
+      densityTexture(0), densityResolution(0), densityLayers(0),
+      renderParamsUBO(0), renderParams{}, time(0.0f),
+      shaderDirectory(defaultShaderDirectory()) {
+}
+
+Renderer::Renderer(ShaderManager& shaderMgr)
+    : VAO(0), VBO(0), directVAO(0), streamVBOs{0, 0, 0, 0}, shaderManager(&shaderMgr),
+      colors(defaultPalette()), speedGradient(defaultSpeedGradient()),
+      screenVAO(0), trailFBOs{0, 0}, trailTextures{0, 0}, trailWidth(0), trailHeight(0),
+      trailIndex(0), trailsActive(false), trailsValid(false), targetFramebuffer(0),
+      targetViewport{0, 0, 0, 0}, targetScissor(false),
+      densityTexture(0), densityResolution(0), densityLayers(0),
+      renderParamsUBO(0), renderParams{}, time(0.0f),
+      shaderDirectory(defaultShaderDirectory()) {
+}
+
 Renderer::~Renderer() {
     cleanup();
 }
@@ -43,43 +73,11 @@ bool Renderer::initialize() {
         shaderManager = ownedShaderManager.get();
     }
     
-    // Embedded shaders for particle rendering
-    const std::string vertexShader = R"(
-        #version 330 core
-        layout (location = 0) in vec2 aPos;
-        layout (location = 1) in vec3 aColor;
-        out vec3 vColor;
-        uniform float uPointSize;
-        void main() {
-            gl_Position = vec4(aPos, 0.0, 1.0);
-            gl_PointSize = uPointSize;
-            vColor = aColor;
-        }
-    )";
-    
-    const std::string fragmentShader = R"(
-        #version 330 core
-        in vec3 vColor;
-        out vec4 FragColor;
-        uniform bool uEnableGlow;
-        void main() {
-            vec2 coord = gl_PointCoord - vec2(0.5);
-            float dist = length(coord);
-            if (dist > 0.5) discard;
-            float alpha = smoothstep(0.5, 0.35, dist);
-            
-            vec3 color = vColor;
-            if (uEnableGlow) {
-                float glow = exp(-dist * 3.0);
-                color = mix(vColor, vec3(1.0), glow * 0.4);
-            }
-            
-            FragColor = vec4(color, alpha);
-        }
-    )";
-    
-    if (!shaderManager->loadShadersFromSource(vertexShader, fragmentShader)) {
-        std::cerr << "Failed to load particle shaders" << std::endl;
+    quadShader = std::make_unique<ShaderManager>();
+    vectorShader = std::make_unique<ShaderManager>();
+    screenShader = std::make_unique<ShaderManager>();
+    densityShader = std::make_unique<ShaderManager>();
+    if (!loadShaders()) {
         return false;
     }
     
@@ -90,13 +88,48 @@ bool Renderer::initialize() {
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     
-    // Position attribute (location 0)
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    // Position attribute (location 0): snorm16 -> [-1, 1]
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex),
+                          (void*)offsetof(PackedVertex, x));
     glEnableVertexAttribArray(0);
     
-    // Color attribute (location 1)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+    // Type attribute (location 1): integer palette index
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_BYTE, sizeof(PackedVertex),
+                           (void*)offsetof(PackedVertex, type));
+    glEnableVertexAttribArray(1);
+    
+    // Motion attribute (location 2): velocity / maxSpeed, snorm8 -> [-1, 1]
+    glVertexAttribPointer(2, 2, GL_BYTE, GL_TRUE, sizeof(PackedVertex),
+                          (void*)offsetof(PackedVertex, vx));
+    glEnableVertexAttribArray(2);
+    
+    // Full-screen pass used to fade and composite the trail buffers
+    glGenVertexArrays(1, &screenVAO);
+    
+    // Density mode histogram
+    glGenTextures(1, &densityTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, densityTexture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    
+    // Direct path: attribute layout is taken from the view at upload time
+    glGenVertexArrays(1, &directVAO);
+    glGenBuffers(4, streamVBOs);
+    glBindVertexArray(directVAO);
+    glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    
+    // Render parameter block shared by every program
+    glGenBuffers(1, &renderParamsUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, renderParamsUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(RenderParams), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploadPalette();
     
     // Enable point size and blending
     glEnable(GL_PROGRAM_POINT_SIZE);
@@ -106,7 +139,149 @@ bool Renderer::initialize() {
     return true;
 }
 
+// Directory holding the running executable, empty if it cannot be found
+static std::filesystem::path executableDirectory() {
+    std::error_code error;
+#if defined(__linux__)
+    const std::filesystem::path executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (!error) return executable.parent_path();
+#elif defined(__APPLE__)
+    char buffer[4096];
+    uint32_t size = sizeof(buffer);
+    if (_NSGetExecutablePath(buffer, &size) == 0) {
+        return std::filesystem::canonical(buffer, error).parent_path();
+    }
+#endif
+    return {};
+}
+
+std::string Renderer::defaultShaderDirectory() {
+    std::error_code error;
+#ifdef PARTICLELIFE_SHADER_DIR
+    // Prefer the source tree, so hot-reloaded edits are the ones under version control
+    if (std::filesystem::is_directory(PARTICLELIFE_SHADER_DIR, error)) {
+        return PARTICLELIFE_SHADER_DIR;
+    }
+#endif
+    // Then the resources/ copy next to the executable, wherever it is started from
+    const std::filesystem::path executableDir = executableDirectory();
+    if (!executableDir.empty()) {
+        const std::filesystem::path installed = executableDir / "resources" / "shaders";
+        if (std::filesystem::is_directory(installed, error)) {
+            return installed.string();
+        }
+    }
+    return "resources/shaders";
+}
+
+bool Renderer::loadShaders() {
+    struct ProgramFiles {
+        ShaderManager* program;
+        const char* vertex;
+        const char* fragment;
+        const char* description;
+    };
+    const ProgramFiles programs[] = {
+        {shaderManager, "vertex.glsl", "fragment.glsl", "particle"},
+        {quadShader.get(), "quad_vertex.glsl", "quad_fragment.glsl", "instanced sprite"},
+        {vectorShader.get(), "vector_vertex.glsl", "vector_fragment.glsl", "velocity vector"},
+        {screenShader.get(), "screen_vertex.glsl", "screen_fragment.glsl", "trail"},
+        {densityShader.get(), "screen_vertex.glsl", "density_fragment.glsl", "density"},
+    };
+    
+    // Build the whole set first and install it only if every program built:
+    // the programs share interfaces through #include (render_params.glsl), so
+    // a half-swapped set could disagree on them. A failed reload keeps the
+    // previous set running
+    const std::filesystem::path directory(shaderDirectory);
+    std::vector<ShaderManager> built(std::size(programs));
+    bool success = true;
+    for (size_t i = 0; i < built.size(); ++i) {
+        const ProgramFiles& files = programs[i];
+        if (!built[i].loadShadersFromFiles((directory / files.vertex).string(),
+                                           (directory / files.fragment).string())) {
+            std::cerr << "Failed to load " << files.description << " shaders" << std::endl;
+            success = false;
+            continue;
+        }
+        built[i].bindUniformBlock("RenderParams", RENDER_PARAMS_BINDING);
+    }
+    if (!success) return false;
+    
+    // The replaced programs are deleted with `built`
+    for (size_t i = 0; i < built.size(); ++i) {
+        programs[i].program->swap(built[i]);
+    }
+    return true;
+}
+
+void Renderer::setShaderHotReload(bool enabled) {
+    if (!enabled) {
+        shaderWatcher.reset();
+    } else if (!shaderWatcher || shaderWatcher->getDirectory() != shaderDirectory) {
+        shaderWatcher = std::make_unique<FileWatcher>(shaderDirectory);
+    }
+}
+
+bool Renderer::reloadShaders() {
+    const bool success = loadShaders();
+    std::cout << (success ? "Reloaded shaders from " : "Shader reload failed, keeping previous programs for ")
+              << shaderDirectory << std::endl;
+    return success;
+}
+
+void Renderer::uploadPalette() {
+    // Picked up by the next render parameter upload
+    const size_t paletteSize = std::min<size_t>(colors.size(), 8);
+    for (size_t i = 0; i < paletteSize; ++i) {
+        renderParams.palette[i] = glm::vec4(colors[i], 1.0f);
+    }
+    renderParams.paletteSize = static_cast<int32_t>(paletteSize);
+    
+    const size_t stops = std::min<size_t>(speedGradient.size(), 5);
+    for (size_t i = 0; i < stops; ++i) {
+        renderParams.speedGradient[i] = glm::vec4(speedGradient[i], 1.0f);
+    }
+}
+
+void Renderer::updateRenderParams(float interpolation) {
+    time += 0.016f; // Approximate frame time for animation
+    
+    // Per-frame size factors; the per-particle size is resolved in the shader
+    float sizeScale = 1.0f;
+    if (trailsActive && config.halfResolutionTrails) {
+        sizeScale *= 0.5f; // Keep on-screen size when drawing at half resolution
+    }
+    if (config.enablePulsation) {
+        sizeScale *= 1.0f + config.pulsationAmount * std::sin(time * config.pulsationSpeed);
+    }
+    // Sprites grow with zoom so close-ups stay readable
+    sizeScale *= std::min(camera.getZoom(), 8.0f);
+    
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    
+    renderParams.view = camera.getViewMatrix();
+    renderParams.pointSize = config.particleSize;
+    renderParams.minSize = config.minParticleSize;
+    renderParams.maxSize = config.maxParticleSize;
+    renderParams.sizeScale = sizeScale;
+    renderParams.speedScale = config.compactVertices ? 1.0f : 1.0f / config.maxSpeed;
+    renderParams.time = time;
+    renderParams.vectorLength = config.velocityVectorLength;
+    renderParams.viewportSize = glm::vec2(static_cast<float>(viewport[2]), static_cast<float>(viewport[3]));
+    renderParams.colorBySpeed = config.colorBySpeed ? 1 : 0;
+    renderParams.sizeBySpeed = config.sizeBySpeed ? 1 : 0;
+    renderParams.enableGlow = config.enableGlow ? 1 : 0;
+    renderParams.interpolation = interpolation;
+    
+    glBindBufferBase(GL_UNIFORM_BUFFER, RENDER_PARAMS_BINDING, renderParamsUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, renderParamsUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(RenderParams), &renderParams);
+}
+
 void Renderer::cleanup() {
+    shaderWatcher.reset();
     if (VAO != 0) {
         glDeleteVertexArrays(1, &VAO);
         VAO = 0;
@@ -115,6 +290,44 @@ void Renderer::cleanup() {
         glDeleteBuffers(1, &VBO);
         VBO = 0;
     }
+    if (directVAO != 0) {
+        glDeleteVertexArrays(1, &directVAO);
+        directVAO = 0;
+    }
+    if (streamVBOs[0] != 0) {
+        glDeleteBuffers(4, streamVBOs);
+        streamVBOs[0] = streamVBOs[1] = streamVBOs[2] = streamVBOs[3] = 0;
+    }
+    destroyTrailTargets();
+    if (renderParamsUBO != 0) {
+        glDeleteBuffers(1, &renderParamsUBO);
+        renderParamsUBO = 0;
+    }
+    if (screenVAO != 0) {
+        glDeleteVertexArrays(1, &screenVAO);
+        screenVAO = 0;
+    }
+    if (screenShader) {
+        screenShader->cleanup();
+        screenShader.reset();
+    }
+    if (densityTexture != 0) {
+        glDeleteTextures(1, &densityTexture);
+        densityTexture = 0;
+    }
+    densityResolution = densityLayers = 0;
+    if (densityShader) {
+        densityShader->cleanup();
+        densityShader.reset();
+    }
+    if (quadShader) {
+        quadShader->cleanup();
+        quadShader.reset();
+    }
+    if (vectorShader) {
+        vectorShader->cleanup();
+        vectorShader.reset();
+    }
     if (shaderManager && ownedShaderManager) {
         shaderManager->cleanup();
         ownedShaderManager.reset();
@@ -122,98 +335,447 @@ void Renderer::cleanup() {
     }
 }
 
+bool Renderer::ensureTrailTargets(int width, int height) {
+    if (trailFBOs[0] != 0 && width == trailWidth && height == trailHeight) {
+        return true;
+    }
+    destroyTrailTargets();
+    
+    glGenFramebuffers(2, trailFBOs);
+    glGenTextures(2, trailTextures);
+    for (int i = 0; i < 2; ++i) {
+        // Half floats so a 0.95 fade decays smoothly to black instead of
+        // getting stuck on 8-bit rounding
+        glBindTexture(GL_TEXTURE_2D, trailTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, trailFBOs[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, trailTextures[i], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Trail framebuffer is incomplete" << std::endl;
+            destroyTrailTargets();
+            glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+            return false;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    trailWidth = width;
+    trailHeight = height;
+    trailsValid = false;
+    return true;
+}
+
+void Renderer::destroyTrailTargets() {
+    if (trailFBOs[0] != 0) {
+        glDeleteFramebuffers(2, trailFBOs);
+        trailFBOs[0] = trailFBOs[1] = 0;
+    }
+    if (trailTextures[0] != 0) {
+        glDeleteTextures(2, trailTextures);
+        trailTextures[0] = trailTextures[1] = 0;
+    }
+    trailWidth = trailHeight = 0;
+    trailsValid = false;
+}
+
+void Renderer::beginTrailFrame() {
+    const int scale = config.halfResolutionTrails ? 2 : 1;
+    const int width = std::max(1, targetViewport[2] / scale);
+    const int height = std::max(1, targetViewport[3] / scale);
+    if (!ensureTrailTargets(width, height)) {
+        return;
+    }
+    
+    const int previous = trailIndex;
+    trailIndex = 1 - trailIndex;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, trailFBOs[trailIndex]);
+    glViewport(0, 0, trailWidth, trailHeight);
+    glDisable(GL_SCISSOR_TEST);
+    
+    if (trailsValid) {
+        // Fade pass: previous accumulation * intensity into the new target
+        Profiler::Scope zone(Profiler::DRAW);
+        glDisable(GL_BLEND);
+        screenShader->use();
+        screenShader->setInt("uTexture", 0);
+        screenShader->setFloat("uScale", config.trailIntensity);
+        screenShader->setBool("uPreserveHue", false);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, trailTextures[previous]);
+        glBindVertexArray(screenVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_BLEND);
+    } else {
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    
+    // New particles accumulate on top of the faded history
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    trailsActive = true;
+    trailsValid = true;
+}
+
 void Renderer::setupFrame() {
+    if (shaderWatcher && shaderWatcher->poll()) {
+        reloadShaders();
+    }
+    
+    // Remember where the caller wants the frame to end up
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+    targetScissor = glIsEnabled(GL_SCISSOR_TEST);
+    trailsActive = false;
+    
+    const glm::vec3 background = backgroundColor();
+    glClearColor(background.r, background.g, background.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
     if (config.enableTrails) {
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f - config.trailIntensity);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        beginTrailFrame();
     } else {
-        glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        trailsValid = false;
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
 }
 
-void Renderer::renderParticles(const std::vector<Particle>& particles) {
-    if (!shaderManager || particles.empty()) return;
+void Renderer::present() {
+    if (!trailsActive) return;
+    trailsActive = false;
     
-    // Prepare vertex data - use static to avoid reallocations
-    static std::vector<float> vertexData;
-    vertexData.clear();
-    vertexData.reserve(particles.size() * 5);
+    // Composite the accumulated trails additively over the cleared background
+    Profiler::Scope zone(Profiler::DRAW);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+    if (targetScissor) glEnable(GL_SCISSOR_TEST);
     
-    static float time = 0.0f;
-    time += 0.016f; // Approximate frame time for animation
+    glBlendFunc(GL_ONE, GL_ONE);
+    screenShader->use();
+    screenShader->setInt("uTexture", 0);
+    screenShader->setFloat("uScale", 1.0f);
+    screenShader->setBool("uPreserveHue", true);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, trailTextures[trailIndex]);
+    glBindVertexArray(screenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
     
-    if (config.colorBySpeed) {
-        // Color by velocity - with speed calculations
-        const float invMaxSpeed = 1.0f / config.maxSpeed;
-        for (const auto& p : particles) {
-            vertexData.push_back(p.x);
-            vertexData.push_back(p.y);
-            
-            // Color by velocity magnitude
-            float speed = std::sqrt(p.vx * p.vx + p.vy * p.vy);
-            float t = std::min(speed * invMaxSpeed, 1.0f);
-            
-            glm::vec3 color;
-            // More vibrant color transition: blue -> cyan -> green -> yellow -> red
-            if (t < 0.25f) {
-                float localT = t * 4.0f; // Precalculate division
-                color = glm::mix(glm::vec3(0.2f, 0.2f, 1.0f), glm::vec3(0.2f, 1.0f, 1.0f), localT);
-            } else if (t < 0.5f) {
-                float localT = (t - 0.25f) * 4.0f;
-                color = glm::mix(glm::vec3(0.2f, 1.0f, 1.0f), glm::vec3(0.2f, 1.0f, 0.2f), localT);
-            } else if (t < 0.75f) {
-                float localT = (t - 0.5f) * 4.0f;
-                color = glm::mix(glm::vec3(0.2f, 1.0f, 0.2f), glm::vec3(1.0f, 1.0f, 0.2f), localT);
-            } else {
-                float localT = (t - 0.75f) * 4.0f;
-                color = glm::mix(glm::vec3(1.0f, 1.0f, 0.2f), glm::vec3(1.0f, 0.2f, 0.2f), localT);
-            }
-            
-            vertexData.push_back(color.r);
-            vertexData.push_back(color.g);
-            vertexData.push_back(color.b);
-        }
-    } else {
-        // Simple type-based coloring (faster)
-        const size_t colorCount = colors.size();
-        for (const auto& p : particles) {
-            vertexData.push_back(p.x);
-            vertexData.push_back(p.y);
-            
-            const glm::vec3& color = colors[p.type % colorCount];
-            vertexData.push_back(color.r);
-            vertexData.push_back(color.g);
-            vertexData.push_back(color.b);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Renderer::packVertices(const ParticleView& particles, float maxSpeed,
+                            std::vector<PackedVertex>& out, float alpha) {
+    out.resize(particles.count);
+    
+    const bool blend = particles.hasPrevious() && alpha < 1.0f;
+    const float invMaxSpeed = maxSpeed > 0.0f ? 1.0f / maxSpeed : 0.0f;
+    for (size_t i = 0; i < particles.count; ++i) {
+        PackedVertex& v = out[i];
+        
+        float x = particles.x(i);
+        float y = particles.y(i);
+        if (blend) {
+            x = particles.previousX(i) + (x - particles.previousX(i)) * alpha;
+            y = particles.previousY(i) + (y - particles.previousY(i)) * alpha;
         }
+        v.x = static_cast<int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+        v.y = static_cast<int16_t>(std::lround(std::clamp(y, -1.0f, 1.0f) * 32767.0f));
+        v.type = static_cast<uint8_t>(particles.typeAt(i));
+        
+        v.vx = static_cast<int8_t>(std::lround(std::clamp(particles.vx(i) * invMaxSpeed, -1.0f, 1.0f) * 127.0f));
+        v.vy = static_cast<int8_t>(std::lround(std::clamp(particles.vy(i) * invMaxSpeed, -1.0f, 1.0f) * 127.0f));
+        v.padding = 0;
+    }
+}
+
+void Renderer::uploadPacked(const ParticleView& particles, float alpha) {
+    // 8 bytes per particle; colours are resolved in the vertex shader.
+    // Packing touches every particle anyway, so interpolation happens here
+    {
+        Profiler::Scope zone(Profiler::VERTEX_BUILD);
+        packVertices(particles, config.maxSpeed, vertexData, alpha);
     }
     
-    // Upload vertex data
+    Profiler::Scope zone(Profiler::UPLOAD);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), 
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(PackedVertex),
                  vertexData.data(), GL_DYNAMIC_DRAW);
+    glBindVertexArray(VAO);
+}
+
+void Renderer::uploadStreams(const ParticleView& particles) {
+    Profiler::Scope zone(Profiler::UPLOAD);
+    glBindVertexArray(directVAO);
+    
+    // Previous positions always live in their own array
+    if (particles.hasPrevious()) {
+        glBindBuffer(GL_ARRAY_BUFFER, streamVBOs[3]);
+        glBufferData(GL_ARRAY_BUFFER, (particles.count - 1) * particles.previousPosition.stride + 2 * sizeof(float),
+                     particles.previousPosition.data, GL_STREAM_DRAW);
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(particles.previousPosition.stride), (void*)0);
+        glEnableVertexAttribArray(3);
+    } else {
+        glDisableVertexAttribArray(3);
+    }
+    
+    if (particles.isInterleaved()) {
+        // AoS: the whole particle array goes up in one copy and every
+        // attribute is an offset into the same buffer
+        const char* base = static_cast<const char*>(particles.position.data);
+        const GLsizei stride = static_cast<GLsizei>(particles.position.stride);
+        const size_t velocityOffset = static_cast<const char*>(particles.velocity.data) - base;
+        const size_t typeOffset = static_cast<const char*>(particles.type.data) - base;
+        
+        // Stop after the last particle's fields: a subsampled view's stride
+        // spans several particles
+        const size_t lastEnd = std::max({2 * sizeof(float), velocityOffset + 2 * sizeof(float),
+                                         typeOffset + sizeof(int)});
+        glBindBuffer(GL_ARRAY_BUFFER, streamVBOs[0]);
+        glBufferData(GL_ARRAY_BUFFER, (particles.count - 1) * stride + lastEnd, base, GL_STREAM_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        // Particle::type is a non-negative int; aType is declared uint
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride, (void*)typeOffset);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)velocityOffset);
+        return;
+    }
+    
+    // SoA: each array gets its own buffer
+    auto uploadStream = [&](GLuint buffer, const ParticleView::Stream& stream, size_t elementSize) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, (particles.count - 1) * stream.stride + elementSize,
+                     stream.data, GL_STREAM_DRAW);
+    };
+    
+    uploadStream(streamVBOs[0], particles.position, 2 * sizeof(float));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(particles.position.stride), (void*)0);
+    
+    uploadStream(streamVBOs[1], particles.type, sizeof(int));
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, static_cast<GLsizei>(particles.type.stride), (void*)0);
+    
+    uploadStream(streamVBOs[2], particles.velocity, 2 * sizeof(float));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(particles.velocity.stride), (void*)0);
+}
+
+int Renderer::binDensity(const ParticleView& particles, int resolution, int maxLayers,
+                         std::vector<float>& out, std::vector<uint32_t>& scratch) {
+    out.clear();
+    if (particles.empty() || resolution <= 0 || maxLayers <= 0) return 0;
+    
+    const size_t count = particles.count;
+    int maxType = 0;
+    #pragma omp parallel for reduction(max : maxType) schedule(static)
+    for (size_t i = 0; i < count; ++i) {
+        maxType = std::max(maxType, particles.typeAt(i));
+    }
+    const int layers = std::min(maxType + 1, maxLayers);
+    const size_t layerSize = static_cast<size_t>(resolution) * resolution;
+    const size_t gridSize = layerSize * layers;
+    
+    // Each chunk counts into a private histogram, so no atomics are needed;
+    // the chunks are summed cell by cell afterwards. Every histogram costs a
+    // clear and a pass of the reduction, so chunks are only split off while
+    // each still covers several times its grid in particles. Large grids
+    // with fewer particles share one histogram with atomic increments
+    const size_t minChunk = 1 << 15;
+    size_t threads = 1;
+#ifdef _OPENMP
+    threads = static_cast<size_t>(std::max(1, omp_get_max_threads()));
+#endif
+    const size_t chunks = std::max<size_t>(1, std::min({threads, count / minChunk, count / (4 * gridSize)}));
+    const bool shared = chunks == 1 && threads > 1 && count >= minChunk;
+    if (scratch.size() != chunks * gridSize) {
+        scratch.resize(chunks * gridSize);
+    }
     
-    // Render particles with dynamic sizing
-    shaderManager->use();
+    const float scale = 0.5f * static_cast<float>(resolution);
+    auto cellOf = [&](size_t i) {
+        const int cx = std::clamp(static_cast<int>((particles.x(i) + 1.0f) * scale), 0, resolution - 1);
+        const int cy = std::clamp(static_cast<int>((particles.y(i) + 1.0f) * scale), 0, resolution - 1);
+        const int layer = particles.typeAt(i) % layers;
+        return layer * layerSize + cy * resolution + cx;
+    };
     
-    float particleSize = config.particleSize;
+    if (shared) {
+        uint32_t* histogram = scratch.data();
+        #pragma omp parallel for schedule(static)
+        for (size_t cell = 0; cell < gridSize; ++cell) {
+            histogram[cell] = 0;
+        }
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; ++i) {
+            const size_t cell = cellOf(i);
+            #pragma omp atomic
+            histogram[cell]++;
+        }
+    } else {
+        #pragma omp parallel for schedule(static)
+        for (size_t c = 0; c < chunks; ++c) {
+            uint32_t* histogram = scratch.data() + c * gridSize;
+            std::fill(histogram, histogram + gridSize, 0u);
+            const size_t begin = count * c / chunks;
+            const size_t end = count * (c + 1) / chunks;
+            for (size_t i = begin; i < end; ++i) {
+                histogram[cellOf(i)]++;
+            }
+        }
+    }
     
-    // Apply size variation based on speed or pulsation if enabled
-    if (config.sizeBySpeed || config.enablePulsation) {
-        // Apply global pulsation
-        if (config.enablePulsation) {
-            float pulsate = 1.0f + config.pulsationAmount * std::sin(time * config.pulsationSpeed);
-            particleSize *= pulsate;
+    out.resize(gridSize);
+    #pragma omp parallel for schedule(static)
+    for (size_t cell = 0; cell < gridSize; ++cell) {
+        uint32_t total = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            total += scratch[c * gridSize + cell];
         }
+        out[cell] = static_cast<float>(total);
     }
+    return layers;
+}
+
+void Renderer::renderDensity(const ParticleView& particles) {
+    const int resolution = std::max(config.densityResolution, 8);
+    const int paletteSize = static_cast<int>(std::min<size_t>(colors.size(), 8));
+    Profiler::Scope buildZone(Profiler::VERTEX_BUILD);
+    const int layers = binDensity(particles, resolution, paletteSize, densityBins, densityScratch);
+    buildZone.stop();
+    if (layers == 0) return;
     
-    shaderManager->setFloat("uPointSize", particleSize);
-    shaderManager->setBool("uEnableGlow", config.enableGlow);
+    Profiler::Scope uploadZone(Profiler::UPLOAD);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, densityTexture);
+    if (resolution != densityResolution || layers != densityLayers) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R32F, resolution, resolution, layers, 0,
+                     GL_RED, GL_FLOAT, densityBins.data());
+        densityResolution = resolution;
+        densityLayers = layers;
+    } else {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, resolution, resolution, layers,
+                        GL_RED, GL_FLOAT, densityBins.data());
+    }
+    uploadZone.stop();
     
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_POINTS, 0, particles.size());
+    // Exposure is relative to the mean occupancy, so the look holds across counts
+    const float meanPerCell = static_cast<float>(particles.count) /
+                              static_cast<float>(resolution * resolution);
+    densityShader->use();
+    densityShader->setInt("uDensity", 0);
+    densityShader->setInt("uLayers", layers);
+    densityShader->setFloat("uExposure", config.densityExposure / meanPerCell);
+    densityShader->setMat4("uInvView", camera.getInverseViewMatrix());
+    
+    Profiler::Scope drawZone(Profiler::DRAW);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glBindVertexArray(screenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBlendFunc(GL_SRC_ALPHA, trailsActive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Renderer::gatherVisible(const ParticleView& particles, const SpatialHash& cells, float alpha) {
+    Profiler::Scope zone(Profiler::VERTEX_BUILD);
+    glm::vec2 minCorner, maxCorner;
+    camera.getVisibleBounds(minCorner, maxCorner);
+    
+    // Pad by the largest sprite radius plus one step of drift since the grid was built
+    const int viewportSize = std::max(1, std::min(targetViewport[2], targetViewport[3]));
+    const float spriteSize = std::max(config.particleSize, config.maxParticleSize);
+    const float margin = 0.02f + spriteSize / (camera.getZoom() * static_cast<float>(viewportSize));
+    minCorner = glm::max(minCorner - margin, glm::vec2(-1.0f));
+    maxCorner = glm::min(maxCorner + margin, glm::vec2(1.0f));
+    if (minCorner.x > maxCorner.x || minCorner.y > maxCorner.y) {
+        visibleParticles.clear();
+        return;
+    }
+    
+    cells.queryRectInto(minCorner.x, minCorner.y, maxCorner.x, maxCorner.y, visibleIndices);
+    
+    // The copy is made anyway, so positions are interpolated on the way
+    const bool blend = particles.hasPrevious() && alpha < 1.0f;
+    const size_t stride = static_cast<size_t>(std::max(config.renderStride, 1));
+    visibleParticles.resize(visibleIndices.size());
+    size_t visible = 0;
+    for (int index : visibleIndices) {
+        const size_t i = static_cast<size_t>(index);
+        if (i >= particles.count) continue; // Grid built before the particle count changed
+        if (i % stride != 0) continue;
+        Particle& p = visibleParticles[visible++];
+        p.x = particles.x(i);
+        p.y = particles.y(i);
+        if (blend) {
+            p.x = particles.previousX(i) + (p.x - particles.previousX(i)) * alpha;
+            p.y = particles.previousY(i) + (p.y - particles.previousY(i)) * alpha;
+        }
+        p.vx = particles.vx(i);
+        p.vy = particles.vy(i);
+        p.type = particles.typeAt(i);
+    }
+    visibleParticles.resize(visible);
+}
+
+void Renderer::renderParticles(const ParticleView& allParticles, const SpatialHash* cells, float alpha) {
+    if (!shaderManager || allParticles.empty()) return;
+    const ParticleView particles = allParticles.subsample(static_cast<size_t>(std::max(config.renderStride, 1)));
+    
+    const float zoom = camera.getZoom();
+    const bool density = config.densityMode || zoom < config.lodZoom;
+    const bool culled = !density && cells && config.cullToView && zoom > 1.0f;
+    
+    // Only the direct path blends in the vertex shader; the packed and culled
+    // paths copy every particle on the CPU and blend there
+    const bool blendInShader = !density && !culled && !config.compactVertices && particles.hasPrevious();
+    updateRenderParams(blendInShader ? alpha : 1.0f);
+    
+    if (density) {
+        renderDensity(particles);
+        return;
+    }
+    
+    // Zoomed in: upload only what the grid says can be on screen
+    if (culled) {
+        gatherVisible(allParticles, *cells, alpha); // Grid indices refer to the full view
+        if (visibleParticles.empty()) return;
+        renderPoints(ParticleView(visibleParticles), 1.0f);
+        return;
+    }
+    renderPoints(particles, alpha);
+}
+
+void Renderer::renderPoints(const ParticleView& particles, float alpha) {
+    if (config.compactVertices) {
+        uploadPacked(particles, alpha);
+    } else {
+        uploadStreams(particles);
+    }
+    
+    // Everything else comes from the RenderParams block
+    Profiler::Scope zone(Profiler::DRAW);
+    ShaderManager* program = config.instancedQuads ? quadShader.get() : shaderManager;
+    program->use();
+    
+    // Attributes advance per vertex for points, per instance for quads
+    const GLuint divisor = config.instancedQuads ? 1 : 0;
+    for (GLuint attribute = 0; attribute < 4; ++attribute) {
+        glVertexAttribDivisor(attribute, divisor);
+    }
+    
+    if (config.instancedQuads) {
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(particles.count));
+    } else {
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(particles.count));
+    }
+    
+    if (config.showVelocityVectors) {
+        // Same VAO and buffers as the sprites, one line instance per particle
+        for (GLuint attribute = 0; attribute < 4; ++attribute) {
+            glVertexAttribDivisor(attribute, 1);
+        }
+        vectorShader->use();
+        glDrawArraysInstanced(GL_LINES, 0, 2, static_cast<GLsizei>(particles.count));
+    }
 }
 
 void Renderer::setViewport(int width, int height) {
@@ -2,6 +2,49 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length,
+                                              GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary,
+                                           GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+static GetProgramBinaryProc getProgramBinary = nullptr;
+static ProgramBinaryProc programBinary = nullptr;
+static ProgramParameteriProc programParameteri = nullptr;
+static std::string binaryCacheDirectory; // Empty = cache disabled
+
+// Header of a cache file; the driver blob follows
+struct ProgramBinaryHeader {
+    char magic[4];
+    uint32_t format;
+};
+static const char PROGRAM_BINARY_MAGIC[4] = {'P', 'L', 'P', 'B'};
+
+static uint64_t fnv1a(uint64_t hash, const std::string& data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash ^ 0xff; // Separator so ("ab", "c") and ("a", "bc") differ
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
 
 ShaderManager::ShaderManager() : shaderProgram(0) {
 }
@@ -31,16 +74,36 @@ GLuint ShaderManager::compileShader(const std::string& source, GLenum type) {
     return shader;
 }
 
-std::string ShaderManager::loadShaderFromFile(const std::string& filepath) {
+std::string ShaderManager::loadShaderFromFile(const std::string& filepath, int depth) {
     std::ifstream file(filepath);
     if (!file.is_open()) {
         std::cerr << "Failed to open shader file: " << filepath << std::endl;
         return "";
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    // Resolve `#include "name"` relative to the including file
+    const std::filesystem::path directory = std::filesystem::path(filepath).parent_path();
+    std::string source;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t directive = line.find_first_not_of(" \t");
+        if (directive != std::string::npos && line.compare(directive, 8, "#include") == 0) {
+            const size_t open = line.find('"', directive);
+            const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos || depth >= MAX_INCLUDE_DEPTH) {
+                std::cerr << "Bad #include in " << filepath << ": " << line << std::endl;
+                return "";
+            }
+            const std::string included = loadShaderFromFile(
+                (directory / line.substr(open + 1, close - open - 1)).string(), depth + 1);
+            if (included.empty()) return "";
+            source += included;
+            continue;
+        }
+        source += line;
+        source += '\n';
+    }
+    return source;
 }
 
 bool ShaderManager::loadShadersFromFiles(const std::string& vertexPath, const std::string& fragmentPath) {
@@ -51,43 +114,199 @@ bool ShaderManager::loadShadersFromFiles(const std::string& vertexPath, const st
         return false;
     }
     
-    return loadShadersFromSource(vertexSource, fragmentSource);
+    if (!loadShadersFromSource(vertexSource, fragmentSource)) {
+        std::cerr << "Failed to build program from " << vertexPath << " and " << fragmentPath << std::endl;
+        return false;
+    }
+    return true;
 }
 
 bool ShaderManager::loadShadersFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
-    cleanup(); // Clean up any existing shader
+    // Build into a new program and only replace the current one on success,
+    // so a broken edit during hot reload keeps the last working shader
+    const std::string cachePath = binaryCachePath(vertexSource, fragmentSource);
+    GLuint program = cachePath.empty() ? 0 : loadProgramBinary(cachePath);
     
-    GLuint vertexShader = compileShader(vertexSource, GL_VERTEX_SHADER);
-    if (vertexShader == 0) return false;
-    
-    GLuint fragmentShader = compileShader(fragmentSource, GL_FRAGMENT_SHADER);
-    if (fragmentShader == 0) {
+    if (program == 0) {
+        GLuint vertexShader = compileShader(vertexSource, GL_VERTEX_SHADER);
+        if (vertexShader == 0) return false;
+        
+        GLuint fragmentShader = compileShader(fragmentSource, GL_FRAGMENT_SHADER);
+        if (fragmentShader == 0) {
+            glDeleteShader(vertexShader);
+            return false;
+        }
+        
+        program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        if (!cachePath.empty()) {
+            programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(program);
         glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
+            glDeleteProgram(program);
+            return false;
+        }
+        
+        if (!cachePath.empty()) {
+            saveProgramBinary(program, cachePath);
+        }
+    }
+    
+    cleanup();
+    shaderProgram = program;
+    cacheUniformLocations();
+    return true;
+}
+
+bool ShaderManager::enableBinaryCache(GLADloadproc load, const std::string& directory) {
+    getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(load("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryProc>(load("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriProc>(load("glProgramParameteri"));
+    
+    // Entry points can resolve even when the driver offers no binary formats
+    GLint formats = 0;
+    if (getProgramBinary && programBinary && programParameteri) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    if (formats <= 0 || directory.empty()) {
+        disableBinaryCache();
         return false;
     }
     
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    binaryCacheDirectory = directory;
+    return true;
+}
+
+void ShaderManager::disableBinaryCache() {
+    binaryCacheDirectory.clear();
+}
+
+std::string ShaderManager::binaryCachePath(const std::string& vertexSource, const std::string& fragmentSource) {
+    if (binaryCacheDirectory.empty()) return "";
     
-    GLint success;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    uint64_t key = 14695981039346656037ull;
+    key = fnv1a(key, vertexSource);
+    key = fnv1a(key, fragmentSource);
+    key = fnv1a(key, glString(GL_VENDOR));
+    key = fnv1a(key, glString(GL_RENDERER));
+    key = fnv1a(key, glString(GL_VERSION));
+    
+    std::ostringstream name;
+    name << std::hex << key << ".bin";
+    return (std::filesystem::path(binaryCacheDirectory) / name.str()).string();
+}
+
+GLuint ShaderManager::loadProgramBinary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+    
+    ProgramBinaryHeader header;
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (binary.size() <= sizeof(header)) return 0;
+    std::copy(binary.begin(), binary.begin() + sizeof(header), reinterpret_cast<char*>(&header));
+    if (!std::equal(header.magic, header.magic + 4, PROGRAM_BINARY_MAGIC)) return 0;
+    
+    GLuint program = glCreateProgram();
+    programBinary(program, header.format, binary.data() + sizeof(header),
+                  static_cast<GLsizei>(binary.size() - sizeof(header)));
+    
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
+        // Driver update or foreign blob: drop it, the caller recompiles
+        glDeleteProgram(program);
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderManager::saveProgramBinary(GLuint program, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    
+    std::vector<char> binary(static_cast<size_t>(length));
+    ProgramBinaryHeader header;
+    std::copy(PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_MAGIC + 4, header.magic);
+    GLenum format = 0;
+    getProgramBinary(program, length, nullptr, &format, binary.data());
+    header.format = format;
+    
+    std::error_code error;
+    std::filesystem::create_directories(binaryCacheDirectory, error);
+    
+    // Write then rename, so concurrent jobs never read a partial file
+    const std::string tempPath = path + "." +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) return;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+        if (!file) {
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+void ShaderManager::cacheUniformLocations() {
+    uniformLocations.clear();
+    
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(shaderProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    
+    std::string name(static_cast<size_t>(std::max(maxNameLength, 1)), '\0');
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shaderProgram, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, &name[0]);
+        const std::string uniformName = name.substr(0, static_cast<size_t>(length));
         
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        glDeleteProgram(shaderProgram);
-        shaderProgram = 0;
-        return false;
+        // Members of uniform blocks have no location
+        const GLint location = glGetUniformLocation(shaderProgram, uniformName.c_str());
+        if (location < 0) continue;
+        
+        uniformLocations[uniformName] = location;
+        const size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos) {
+            uniformLocations[uniformName.substr(0, bracket)] = location;
+        }
     }
+}
+
+GLint ShaderManager::getUniformLocation(const std::string& name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+bool ShaderManager::bindUniformBlock(const std::string& blockName, GLuint bindingPoint) const {
+    if (shaderProgram == 0) return false;
     
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    const GLuint blockIndex = glGetUniformBlockIndex(shaderProgram, blockName.c_str());
+    if (blockIndex == GL_INVALID_INDEX) return false;
     
+    glUniformBlockBinding(shaderProgram, blockIndex, bindingPoint);
     return true;
 }
 
@@ -99,25 +318,49 @@ void ShaderManager::use() const {
 
 void ShaderManager::setFloat(const std::string& name, float value) const {
     if (shaderProgram != 0) {
-        glUniform1f(glGetUniformLocation(shaderProgram, name.c_str()), value);
+        glUniform1f(getUniformLocation(name), value);
     }
 }
 
 void ShaderManager::setInt(const std::string& name, int value) const {
     if (shaderProgram != 0) {
-        glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value);
+        glUniform1i(getUniformLocation(name), value);
     }
 }
 
 void ShaderManager::setBool(const std::string& name, bool value) const {
     if (shaderProgram != 0) {
-        glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), value ? 1 : 0);
+        glUniform1i(getUniformLocation(name), value ? 1 : 0);
     }
 }
 
+void ShaderManager::setVec3Array(const std::string& name, const glm::vec3* values, int count) const {
+    if (shaderProgram != 0 && count > 0) {
+        glUniform3fv(getUniformLocation(name), count, &values[0].x);
+    }
+}
+
+void ShaderManager::setVec2(const std::string& name, const glm::vec2& value) const {
+    if (shaderProgram != 0) {
+        glUniform2f(getUniformLocation(name), value.x, value.y);
+    }
+}
+
+void ShaderManager::setMat4(const std::string& name, const glm::mat4& value) const {
+    if (shaderProgram != 0) {
+        glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+    }
+}
+
+void ShaderManager::swap(ShaderManager& other) {
+    std::swap(shaderProgram, other.shaderProgram);
+    uniformLocations.swap(other.uniformLocations);
+}
+
 void ShaderManager::cleanup() {
     if (shaderProgram != 0) {
         glDeleteProgram(shaderProgram);
         shaderProgram = 0;
     }
+    uniformLocations.clear();
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "rendering/SoftwareRenderer.h"
+#include "stb_image_write.h"
+#include <algorithm>
+#include <cmath>
+
+SoftwareRenderer::SoftwareRenderer()
+    : colors(Renderer::defaultPalette()), speedGradient(Renderer::defaultSpeedGradient()),
+      width(0), height(0), tilesX(0), tilesY(0), time(0.0f), trailsValid(false) {
+}
+
+bool SoftwareRenderer::initialize(int w, int h) {
+    if (w <= 0 || h <= 0) return false;
+    
+    width = w;
+    height = h;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    
+    accum.assign(static_cast<size_t>(width) * height, glm::vec3(0.0f));
+    trailsValid = false;
+    pixels.assign(static_cast<size_t>(width) * height * 4, 0);
+    tileOffsets.assign(tilesX * tilesY + 1, 0);
+    return true;
+}
+
+void SoftwareRenderer::setupFrame() {
+    if (config.enableTrails && trailsValid) {
+        // Fade the previous frame instead of clearing it
+        const float fade = config.trailIntensity;
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < accum.size(); ++i) {
+            accum[i] = accum[i] * fade;
+        }
+    } else {
+        // Trail history starts empty; without trails draw straight onto the background
+        const glm::vec3 clear = config.enableTrails ? glm::vec3(0.0f) : Renderer::backgroundColor();
+        std::fill(accum.begin(), accum.end(), clear);
+    }
+    trailsValid = config.enableTrails;
+}
+
+glm::vec3 SoftwareRenderer::particleColor(const ParticleView& particles, size_t i) const {
+    if (!config.colorBySpeed) {
+        return colors[particles.typeAt(i) % colors.size()];
+    }
+    
+    const float vx = particles.vx(i);
+    const float vy = particles.vy(i);
+    const float t = std::min(std::sqrt(vx * vx + vy * vy) / config.maxSpeed, 1.0f);
+    const float s = t * 4.0f;
+    const int stop = std::min(static_cast<int>(s), 3);
+    return glm::mix(speedGradient[stop], speedGradient[stop + 1], s - static_cast<float>(stop));
+}
+
+void SoftwareRenderer::binSplats() {
+    const int tileCount = tilesX * tilesY;
+    std::fill(tileOffsets.begin(), tileOffsets.end(), 0);
+    
+    auto tileRange = [&](const Splat& s, int& x0, int& x1, int& y0, int& y1) {
+        const float r = 0.5f * s.size;
+        x0 = std::max(0, static_cast<int>(std::floor(s.px - r)) / TILE_SIZE);
+        x1 = std::min(tilesX - 1, static_cast<int>(std::floor(s.px + r)) / TILE_SIZE);
+        y0 = std::max(0, static_cast<int>(std::floor(s.py - r)) / TILE_SIZE);
+        y1 = std::min(tilesY - 1, static_cast<int>(std::floor(s.py + r)) / TILE_SIZE);
+    };
+    
+    // Pass 1: count splats per tile
+    for (const Splat& s : splats) {
+        int x0, x1, y0, y1;
+        tileRange(s, x0, x1, y0, y1);
+        for (int ty = y0; ty <= y1; ++ty) {
+            for (int tx = x0; tx <= x1; ++tx) {
+                tileOffsets[ty * tilesX + tx + 1]++;
+            }
+        }
+    }
+    for (int t = 0; t < tileCount; ++t) {
+        tileOffsets[t + 1] += tileOffsets[t];
+    }
+    
+    // Pass 2: scatter indices, preserving draw order within each tile
+    tileSplats.resize(tileOffsets[tileCount]);
+    std::vector<int> cursor(tileOffsets.begin(), tileOffsets.end() - 1);
+    for (size_t i = 0; i < splats.size(); ++i) {
+        int x0, x1, y0, y1;
+        tileRange(splats[i], x0, x1, y0, y1);
+        for (int ty = y0; ty <= y1; ++ty) {
+            for (int tx = x0; tx <= x1; ++tx) {
+                tileSplats[cursor[ty * tilesX + tx]++] = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::rasterizeTile(int tile) {
+    const int tileX0 = (tile % tilesX) * TILE_SIZE;
+    const int tileY0 = (tile / tilesX) * TILE_SIZE;
+    const int tileX1 = std::min(tileX0 + TILE_SIZE, width);
+    const int tileY1 = std::min(tileY0 + TILE_SIZE, height);
+    const bool additive = config.enableTrails;
+    
+    for (int k = tileOffsets[tile]; k < tileOffsets[tile + 1]; ++k) {
+        const Splat& s = splats[tileSplats[k]];
+        const float r = 0.5f * s.size;
+        const float invSize = 1.0f / s.size;
+        
+        const int x0 = std::max(tileX0, static_cast<int>(std::floor(s.px - r)));
+        const int x1 = std::min(tileX1, static_cast<int>(std::ceil(s.px + r)));
+        const int y0 = std::max(tileY0, static_cast<int>(std::floor(s.py - r)));
+        const int y1 = std::min(tileY1, static_cast<int>(std::ceil(s.py + r)));
+        
+        for (int y = y0; y < y1; ++y) {
+            const float dy = (static_cast<float>(y) + 0.5f - s.py) * invSize;
+            glm::vec3* row = &accum[static_cast<size_t>(y) * width];
+            for (int x = x0; x < x1; ++x) {
+                const float dx = (static_cast<float>(x) + 0.5f - s.px) * invSize;
+                
+                // Same falloff as the GL fragment shader (gl_PointCoord space)
+                const float dist = std::sqrt(dx * dx + dy * dy);
+                if (dist > 0.5f) continue;
+                
+                const float t = std::clamp((dist - 0.5f) / (0.35f - 0.5f), 0.0f, 1.0f);
+                const float alpha = t * t * (3.0f - 2.0f * t);
+                
+                glm::vec3 color = s.color;
+                if (config.enableGlow) {
+                    const float glow = std::exp(-dist * 3.0f);
+                    color = glm::mix(s.color, glm::vec3(1.0f), glow * 0.4f);
+                }
+                
+                if (additive) {
+                    row[x] = row[x] + color * alpha;
+                } else {
+                    row[x] = color * alpha + row[x] * (1.0f - alpha);
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::resolve() {
+    const int pixelCount = width * height;
+    const bool trails = config.enableTrails;
+    const glm::vec3 background = Renderer::backgroundColor();
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < pixelCount; ++i) {
+        glm::vec3 c = accum[i];
+        if (trails) {
+            // Renderer::present(): dense areas saturate towards their own
+            // colour, then add onto the background
+            const float peak = std::max({c.r, c.g, c.b, 1.0f});
+            c = c * (1.0f / peak) + background;
+        }
+        pixels[i * 4 + 0] = static_cast<unsigned char>(std::min(c.r, 1.0f) * 255.0f + 0.5f);
+        pixels[i * 4 + 1] = static_cast<unsigned char>(std::min(c.g, 1.0f) * 255.0f + 0.5f);
+        pixels[i * 4 + 2] = static_cast<unsigned char>(std::min(c.b, 1.0f) * 255.0f + 0.5f);
+        pixels[i * 4 + 3] = 255;
+    }
+}
+
+void SoftwareRenderer::renderParticles(const ParticleView& particles) {
+    if (width == 0) return;
+    
+    time += 0.016f; // Matches the GL renderer's animation clock
+    
+    // Per-frame factor on every sprite size, as uSizeScale in the shaders
+    float sizeScale = 1.0f;
+    if (config.enablePulsation) {
+        sizeScale *= 1.0f + config.pulsationAmount * std::sin(time * config.pulsationSpeed);
+    }
+    
+    // Build splats in framebuffer pixel space (top-down rows)
+    splats.resize(particles.count);
+    const float halfW = 0.5f * static_cast<float>(width);
+    const float halfH = 0.5f * static_cast<float>(height);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < particles.count; ++i) {
+        Splat& s = splats[i];
+        s.px = (particles.x(i) + 1.0f) * halfW;
+        s.py = (1.0f - particles.y(i)) * halfH;
+        s.color = particleColor(particles, i);
+        
+        s.size = config.particleSize;
+        if (config.sizeBySpeed) {
+            const float vx = particles.vx(i);
+            const float vy = particles.vy(i);
+            const float t = std::min(std::sqrt(vx * vx + vy * vy) / config.maxSpeed, 1.0f);
+            s.size = config.minParticleSize + t * (config.maxParticleSize - config.minParticleSize);
+        }
+        s.size = std::max(s.size * sizeScale, 1.0f);
+    }
+    
+    binSplats();
+    
+    const int tileCount = tilesX * tilesY;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int tile = 0; tile < tileCount; ++tile) {
+        rasterizeTile(tile);
+    }
+    
+    resolve();
+}
+
+bool SoftwareRenderer::writePNG(const std::string& filename) const {
+    return stbi_write_png(filename.c_str(), width, height, 4, pixels.data(), width * 4) != 0;
+}
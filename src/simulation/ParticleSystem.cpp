@@ -1,4 +1,7 @@
 #include "simulation/ParticleSystem.h"
+#include "ParticleSystemKernels.inl"
+#include "util/PerfCounters.h"
+#include "util/Profiler.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -8,11 +11,10 @@
 #endif
 
 ParticleSystem::ParticleSystem() : spatialHash(0.3f) {
-    rng.seed(std::random_device{}());
+    reseed();
     
     resizeForceMatrix();
     createParticles();
-    lastUpdateTime = std::chrono::high_resolution_clock::now();
 }
 
 float ParticleSystem::wrapCoord(float x) const {
@@ -36,16 +38,18 @@ glm::vec2 ParticleSystem::getWrappedDelta(const glm::vec2& from, const glm::vec2
     return delta;
 }
 
-float ParticleSystem::calculateForce(float dist, float attraction) const {
-    const float beta = 0.3f;
-    if (dist < beta) {
-        // Only apply repulsion if there's actual attraction
-        // This prevents clustering when forces are zero
-        return attraction * (dist / beta - 1.0f);
-    } else if (dist < 1.0f) {
-        return attraction * (1.0f - std::abs(2.0f * dist - 1.0f - beta) / (1.0f - beta));
-    }
-    return 0.0f;
+void ParticleSystem::queryNeighbors(float x, float y, std::vector<int>& out) const {
+    const float radius = config.interactionRadius;
+    spatialHash.queryInto(x, y, radius, out);
+    if (config.boundaryMode != WRAP) return;
+    
+    // Neighbours across the edge sit near the opposite side of the grid
+    const float edge = 1.0f - radius;
+    const float shiftX = x < -edge ? 2.0f : (x > edge ? -2.0f : 0.0f);
+    const float shiftY = y < -edge ? 2.0f : (y > edge ? -2.0f : 0.0f);
+    if (shiftX != 0.0f) spatialHash.appendQuery(x + shiftX, y, radius, out);
+    if (shiftY != 0.0f) spatialHash.appendQuery(x, y + shiftY, radius, out);
+    if (shiftX != 0.0f && shiftY != 0.0f) spatialHash.appendQuery(x + shiftX, y + shiftY, radius, out);
 }
 
 void ParticleSystem::randomizeForces() {
@@ -68,7 +72,10 @@ void ParticleSystem::resizeForceMatrix() {
 }
 
 void ParticleSystem::createParticles() {
+    Profiler::Scope zone(Profiler::CREATE_PARTICLES);
     particles.clear();
+    spatialHashValid = false;
+    previousPositionsValid = false;
     
     std::uniform_real_distribution<float> posDist(-0.5f, 0.5f);
     std::uniform_real_distribution<float> velDist(-0.0005f, 0.0005f);
@@ -85,11 +92,21 @@ void ParticleSystem::createParticles() {
         }
     }
     
-    std::cout << "Created " << particles.size() << " particles with " 
-              << config.numTypes << " types" << std::endl;
+    if (logging) {
+        std::cout << "Created " << particles.size() << " particles with " 
+                  << config.numTypes << " types" << std::endl;
+    }
+}
+
+void ParticleSystem::setParticles(std::vector<Particle> newParticles) {
+    particles = std::move(newParticles);
+    spatialHashValid = false;
+    previousPositionsValid = false;
+    pendingRemovals.clear();
 }
 
 void ParticleSystem::resetSimulation(bool randomForces) {
+    if (config.deterministic) reseed();
     if (randomForces) {
         randomizeForces();
     } else {
@@ -98,7 +115,36 @@ void ParticleSystem::resetSimulation(bool randomForces) {
     createParticles();
 }
 
+void ParticleSystem::reseed() {
+    rng.seed(config.deterministic ? config.seed : std::random_device{}());
+}
+
+uint64_t ParticleSystem::computeStateHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    // Field by field: the bit patterns, never struct padding
+    for (const Particle& p : particles) {
+        mix(&p.x, sizeof(p.x));
+        mix(&p.y, sizeof(p.y));
+        mix(&p.vx, sizeof(p.vx));
+        mix(&p.vy, sizeof(p.vy));
+        mix(&p.type, sizeof(p.type));
+    }
+    return hash;
+}
+
+const std::vector<std::string>& ParticleSystem::presetNames() {
+    static const std::vector<std::string> names = {"Orbits", "Chaos", "Balance", "Swirls", "Snakes"};
+    return names;
+}
+
 void ParticleSystem::loadPreset(const std::string& name) {
+    if (config.deterministic) reseed();
     if (name == "Orbits") {
         config.numTypes = 4;
         forces = {
@@ -142,307 +188,104 @@ void ParticleSystem::loadPreset(const std::string& name) {
         }
     }
     createParticles();
-    std::cout << "Loaded preset: " << name << std::endl;
+    if (logging) std::cout << "Loaded preset: " << name << std::endl;
 }
 
 void ParticleSystem::update(float deltaTime) {
-    if (config.paused) return;
+    if (config.paused) {
+        stepRate.reset();
+        metrics.stepsPerSecond = 0.0f;
+        previousPositionsValid = false; // Nothing moves, so hold still
+        return;
+    }
     
     auto startTime = std::chrono::high_resolution_clock::now();
     metrics.reset();
     
+    previousPositions.resize(2 * particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) {
+        previousPositions[2 * i] = particles[i].x;
+        previousPositions[2 * i + 1] = particles[i].y;
+    }
+    previousPositionsValid = true;
+    
     // Convert real time to normalized simulation time
     // The simulation was designed with dt=1.0 representing one frame at 60fps
     const float targetFrameTime = 1.0f / 60.0f;  // 0.01667 seconds
     const float dt = (deltaTime / targetFrameTime) * config.timeScale;
     
-    // Build spatial hash
-    if (config.useSpatialHash) {
-        spatialHash.clear();
-        for (size_t i = 0; i < particles.size(); ++i) {
-            spatialHash.insert(i, particles[i].x, particles[i].y);
-        }
-    }
+    buildSpatialHash();
+    computeForces();
+    integrate(dt);
+    compactParticles();
     
-    // Calculate forces
-    std::vector<float> fx(particles.size(), 0.0f);
-    std::vector<float> fy(particles.size(), 0.0f);
+    // Update performance metrics
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    metrics.updateTimeMs = duration.count() / 1000.0f;
     
-    const size_t n = particles.size();
-    const float radiusSq = config.interactionRadius * config.interactionRadius;
-    const float invRadius = 1.0f / config.interactionRadius;
-    const float forceFactor = config.forceFactor;
+    stepRate.tick();
+    metrics.stepsPerSecond = stepRate.getRate();
     
-    // Only use parallel processing for larger particle counts
-    const bool useParallel = (n > 200);
+    if (config.deterministic) {
+        metrics.stateHash = computeStateHash();
+    }
+}
+
+void ParticleSystem::buildSpatialHash() {
+    if (!config.useSpatialHash) return;
     
-    // Process particles - only parallelize if beneficial
-    if (useParallel) {
-        #pragma omp parallel for schedule(dynamic, 64)
-        for (size_t i = 0; i < n; ++i) {
-            // Thread-local neighbor buffer (each thread gets its own)
-            std::vector<int> neighbors;
-            neighbors.reserve(100);
-            
-            const float px = particles[i].x;
-            const float py = particles[i].y;
-            const int ptype = particles[i].type;
-            
-            if (config.useSpatialHash) {
-                spatialHash.queryInto(px, py, config.interactionRadius, neighbors);
-                #pragma omp atomic
-                metrics.spatialQueries++;
-            } else {
-                // Brute force: check all particles
-                neighbors.reserve(n);
-                for (size_t j = 0; j < n; ++j) {
-                    neighbors.push_back(j);
-                }
-            }
-            
-            float force_x = 0.0f;
-            float force_y = 0.0f;
-            
-            // Vectorized inner loop - compiler can auto-vectorize this
-            for (size_t idx = 0; idx < neighbors.size(); ++idx) {
-                const int j = neighbors[idx];
-                if (i == static_cast<size_t>(j)) continue;
-                
-                // Calculate delta (vectorizable)
-                float dx, dy;
-                if (config.boundaryMode == WRAP) {
-                    dx = particles[j].x - px;
-                    dy = particles[j].y - py;
-                    // Wrap handling
-                    if (dx > 0.5f) dx -= 1.0f;
-                    else if (dx < -0.5f) dx += 1.0f;
-                    if (dy > 0.5f) dy -= 1.0f;
-                    else if (dy < -0.5f) dy += 1.0f;
-                } else {
-                    dx = particles[j].x - px;
-                    dy = particles[j].y - py;
-                }
-                
-                const float distSq = dx * dx + dy * dy;
-                
-                // Branchless distance check using masking
-                const bool inRange = (distSq > 0.00001f) && (distSq < radiusSq);
-                if (inRange) {
-                    const float invDist = 1.0f / std::sqrt(distSq);
-                    const float dist = distSq * invDist;
-                    const float normDist = dist * invRadius;
-                    
-                    const float attraction = forces[ptype][particles[j].type];
-                    const float force = calculateForce(normDist, attraction) * forceFactor;
-                    
-                    force_x += dx * invDist * force;
-                    force_y += dy * invDist * force;
-                    
-                    #pragma omp atomic
-                    metrics.forceCalculations++;
-                }
-            }
-            
-            // Mouse interaction (done serially, not in parallel section)
-            if (config.mousePressed) {
-                const float dx = config.mouseX - px;
-                const float dy = config.mouseY - py;
-                const float distSq = dx * dx + dy * dy;
-                const float mouseRadiusSq = config.mouseRadius * config.mouseRadius;
-                
-                if (distSq < mouseRadiusSq && distSq > 0.00001f) {
-                    const float invDist = 1.0f / std::sqrt(distSq);
-                    const float dist = distSq * invDist;
-                    const float strength = (1.0f - dist / config.mouseRadius);
-                    const float forceMagnitude = config.mouseForce * strength * invDist;
-                    
-                    force_x += dx * forceMagnitude;
-                    force_y += dy * forceMagnitude;
-                }
-            }
-            
-            fx[i] = force_x;
-            fy[i] = force_y;
-        }
+    Profiler::Scope zone(Profiler::GRID_BUILD);
+    PerfCounters::Scope counters(PerfCounters::GRID_BUILD);
+    spatialHash.clear();
+    for (size_t i = 0; i < particles.size(); ++i) {
+        spatialHash.insert(i, particles[i].x, particles[i].y);
+    }
+    PerfCounters::instance().countParticles(PerfCounters::GRID_BUILD, particles.size());
+    spatialHashValid = true;
+}
+
+// The strict variants are instantiated in ParticleSystemStrict.cpp, under its
+// own float flags; never here
+extern template void ParticleSystem::computeForcesKernel<true>();
+extern template void ParticleSystem::integrateKernel<true>(float dt);
+template void ParticleSystem::computeForcesKernel<false>();
+template void ParticleSystem::integrateKernel<false>(float dt);
+
+void ParticleSystem::computeForces() {
+    if (config.deterministic) {
+        computeForcesKernel<true>();
     } else {
-        // Sequential processing for small particle counts (more stable)
-        std::vector<int> neighbors;
-        neighbors.reserve(100);
-        
-        for (size_t i = 0; i < n; ++i) {
-            neighbors.clear();
-            
-            const float px = particles[i].x;
-            const float py = particles[i].y;
-            const int ptype = particles[i].type;
-        
-            if (config.useSpatialHash) {
-                spatialHash.queryInto(px, py, config.interactionRadius, neighbors);
-                metrics.spatialQueries++;
-            } else {
-                // Brute force: check all particles
-                neighbors.reserve(n);
-                for (size_t j = 0; j < n; ++j) {
-                    neighbors.push_back(j);
-                }
-            }
-            
-            float force_x = 0.0f;
-            float force_y = 0.0f;
-            
-            // Vectorized inner loop
-            for (size_t idx = 0; idx < neighbors.size(); ++idx) {
-                const int j = neighbors[idx];
-                if (i == static_cast<size_t>(j)) continue;
-                
-                float dx, dy;
-                if (config.boundaryMode == WRAP) {
-                    dx = particles[j].x - px;
-                    dy = particles[j].y - py;
-                    if (dx > 0.5f) dx -= 1.0f;
-                    else if (dx < -0.5f) dx += 1.0f;
-                    if (dy > 0.5f) dy -= 1.0f;
-                    else if (dy < -0.5f) dy += 1.0f;
-                } else {
-                    dx = particles[j].x - px;
-                    dy = particles[j].y - py;
-                }
-                
-                const float distSq = dx * dx + dy * dy;
-                
-                const bool inRange = (distSq > 0.00001f) && (distSq < radiusSq);
-                if (inRange) {
-                    const float invDist = 1.0f / std::sqrt(distSq);
-                    const float dist = distSq * invDist;
-                    const float normDist = dist * invRadius;
-                    
-                    const float attraction = forces[ptype][particles[j].type];
-                    const float force = calculateForce(normDist, attraction) * forceFactor;
-                    
-                    force_x += dx * invDist * force;
-                    force_y += dy * invDist * force;
-                    metrics.forceCalculations++;
-                }
-            }
-            
-            // Mouse interaction
-            if (config.mousePressed) {
-                const float dx = config.mouseX - px;
-                const float dy = config.mouseY - py;
-                const float distSq = dx * dx + dy * dy;
-                const float mouseRadiusSq = config.mouseRadius * config.mouseRadius;
-                
-                if (distSq < mouseRadiusSq && distSq > 0.00001f) {
-                    const float invDist = 1.0f / std::sqrt(distSq);
-                    const float dist = distSq * invDist;
-                    const float strength = (1.0f - dist / config.mouseRadius);
-                    const float forceMagnitude = config.mouseForce * strength * invDist;
-                    
-                    force_x += dx * forceMagnitude;
-                    force_y += dy * forceMagnitude;
-                }
-            }
-            
-            fx[i] = force_x;
-            fy[i] = force_y;
-        }
+        computeForcesKernel<false>();
     }
+}
+
+void ParticleSystem::integrate(float dt) {
+    if (config.deterministic) {
+        integrateKernel<true>(dt);
+    } else {
+        integrateKernel<false>(dt);
+    }
+}
+
+void ParticleSystem::compactParticles() {
+    if (pendingRemovals.empty()) return;
+    Profiler::Scope zone(Profiler::COMPACTION);
     
-    // Update particles - vectorized velocity integration
-    std::vector<size_t> toRemove;
-    
-    const float frictionFactor = config.friction;
-    const float maxSpeedSq = config.maxSpeed * config.maxSpeed;
-    
-    // This loop can be auto-vectorized by the compiler with -O3 -march=native
-    #pragma omp simd
-    for (size_t i = 0; i < n; ++i) {
-        // Velocity update with force application
-        particles[i].vx += fx[i] * dt;
-        particles[i].vy += fy[i] * dt;
-        
-        // Apply friction
-        particles[i].vx *= frictionFactor;
-        particles[i].vy *= frictionFactor;
-        
-        // Speed limiting (branchless where possible)
-        const float speedSq = particles[i].vx * particles[i].vx + particles[i].vy * particles[i].vy;
-        if (speedSq > maxSpeedSq) {
-            const float invSpeed = 1.0f / std::sqrt(speedSq);
-            const float speedLimit = config.maxSpeed * invSpeed;
-            particles[i].vx *= speedLimit;
-            particles[i].vy *= speedLimit;
-        }
-        
-    // Advance one step.
-    particles[i].x += particles[i].vx * dt;
-    particles[i].y += particles[i].vy * dt;
-        
-        // Boundary handling - use fixed ±0.99 to keep particles cleanly inside viewport
-        const float boundary = 0.99f;  // Slightly inset for clean edges
-        const float damping = 0.8f;
-        
-        if (config.boundaryMode == WRAP) {
-            // Instant wrapping
-            if (particles[i].x < -boundary) particles[i].x = boundary - 0.001f;
-            else if (particles[i].x > boundary) particles[i].x = -boundary + 0.001f;
-            if (particles[i].y < -boundary) particles[i].y = boundary - 0.001f;
-            else if (particles[i].y > boundary) particles[i].y = -boundary + 0.001f;
-        } else if (config.boundaryMode == BOUNCE) {
-            // Hard bounce at boundary
-            if (particles[i].x < -boundary) {
-                particles[i].x = -boundary;
-                particles[i].vx = std::abs(particles[i].vx) * damping;
-            } else if (particles[i].x > boundary) {
-                particles[i].x = boundary;
-                particles[i].vx = -std::abs(particles[i].vx) * damping;
-            }
-            
-            if (particles[i].y < -boundary) {
-                particles[i].y = -boundary;
-                particles[i].vy = std::abs(particles[i].vy) * damping;
-            } else if (particles[i].y > boundary) {
-                particles[i].y = boundary;
-                particles[i].vy = -std::abs(particles[i].vy) * damping;
-            }
-        } else if (config.boundaryMode == KILL) {
-            if (particles[i].x < -boundary || particles[i].x > boundary ||
-                particles[i].y < -boundary || particles[i].y > boundary) {
-                toRemove.push_back(i);
-            }
-        }
+    spatialHashValid = false; // Stored indices now point at shifted particles
+    if (previousPositions.size() != 2 * particles.size()) {
+        previousPositionsValid = false;
+        previousPositions.clear();
     }
     
     // Remove out-of-bounds particles (in reverse order)
-    for (auto it = toRemove.rbegin(); it != toRemove.rend(); ++it) {
+    for (auto it = pendingRemovals.rbegin(); it != pendingRemovals.rend(); ++it) {
         particles.erase(particles.begin() + *it);
-    }
-    
-    // Update performance metrics
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-    metrics.updateTimeMs = duration.count() / 1000.0f;
-    
-    // Update FPS calculation
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    auto frameDuration = std::chrono::duration_cast<std::chrono::microseconds>(currentTime - lastUpdateTime);
-    lastUpdateTime = currentTime;
-    
-    if (frameDuration.count() > 0) {
-        float currentFPS = 1000000.0f / frameDuration.count();
-        fpsHistory.push_back(currentFPS);
-        
-        if (fpsHistory.size() > maxFpsHistory) {
-            fpsHistory.erase(fpsHistory.begin());
-        }
-        
-        // Calculate average FPS
-        float sum = 0.0f;
-        for (float fps : fpsHistory) {
-            sum += fps;
+        if (!previousPositions.empty()) {
+            previousPositions.erase(previousPositions.begin() + 2 * *it, previousPositions.begin() + 2 * *it + 2);
         }
-        metrics.averageFPS = sum / fpsHistory.size();
     }
+    pendingRemovals.clear();
 }
 
 void ParticleSystem::setMousePosition(float x, float y) {
@@ -462,6 +305,8 @@ void ParticleSystem::spawnParticlesAtMouse(int count, int type) {
     std::uniform_real_distribution<float> radiusDist(0.0f, config.spawnRadius);
     std::uniform_real_distribution<float> velDist(-0.001f, 0.001f);
     
+    spatialHashValid = false;
+    previousPositionsValid = false;
     for (int i = 0; i < count; ++i) {
         Particle p;
         
@@ -497,6 +342,10 @@ void ParticleSystem::removeParticlesAtMouse(float radius) {
     }
     
     // Remove in reverse order to maintain indices
+    if (!toRemove.empty()) {
+        spatialHashValid = false;
+        previousPositionsValid = false;
+    }
     for (auto it = toRemove.rbegin(); it != toRemove.rend(); ++it) {
         particles.erase(particles.begin() + *it);
     }
@@ -533,6 +382,8 @@ void ParticleSystem::addParticles(int count, int type) {
     std::uniform_real_distribution<float> posDist(-0.5f, 0.5f);
     std::uniform_real_distribution<float> velDist(-0.001f, 0.001f);
     
+    spatialHashValid = false;
+    previousPositionsValid = false;
     for(int i=0; i<count; ++i) {
         Particle p;
         p.x = posDist(rng);
@@ -547,6 +398,8 @@ void ParticleSystem::addParticles(int count, int type) {
 
 void ParticleSystem::removeParticles(int count) {
     if (particles.empty()) return;
+    spatialHashValid = false;
+    previousPositionsValid = false;
     if (count >= particles.size()) {
         particles.clear();
         return;
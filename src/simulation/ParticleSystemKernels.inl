@@ -0,0 +1,339 @@
+// Force and integration kernels of ParticleSystem. Included by
+// ParticleSystem.cpp, built with the project's float flags, and by
+// ParticleSystemStrict.cpp, built without fast math or FMA contraction, which
+// each instantiate one variant; see ParticleSystem::Config::deterministic.
+// Everything here must stay local to the including file so the two builds
+// never share code.
+#pragma once
+
+#include "simulation/ParticleSystem.h"
+#include "util/PerfCounters.h"
+#include "util/Profiler.h"
+#include <cmath>
+
+namespace {
+
+// Force between two particles at `dist` (in interaction radii)
+inline float forceProfile(float dist, float attraction) {
+    const float beta = 0.3f;
+    if (dist < beta) {
+        // Only apply repulsion if there's actual attraction
+        // This prevents clustering when forces are zero
+        return attraction * (dist / beta - 1.0f);
+    } else if (dist < 1.0f) {
+        return attraction * (1.0f - std::abs(2.0f * dist - 1.0f - beta) / (1.0f - beta));
+    }
+    return 0.0f;
+}
+
+} // namespace
+
+template <bool Strict>
+void ParticleSystem::computeForcesKernel() {
+    forceX.resize(particles.size());
+    forceY.resize(particles.size());
+    
+    const size_t n = particles.size();
+    const float radiusSq = config.interactionRadius * config.interactionRadius;
+    const float invRadius = 1.0f / config.interactionRadius;
+    const float forceFactor = config.forceFactor;
+    
+    // Only use parallel processing for larger particle counts
+    const bool useParallel = (n > 200);
+    
+    // Neighbour lookups are too short to time one by one; every
+    // QUERY_SAMPLE_INTERVAL-th is timed and the sum scaled up
+    constexpr size_t QUERY_SAMPLE_INTERVAL = 8;
+    
+    // Each particle's force is summed by one thread over its neighbours in
+    // grid insertion order, so the result does not depend on the thread
+    // count or the schedule; there is no cross-thread float reduction
+    // Process particles - only parallelize if beneficial
+    if (useParallel) {
+        #pragma omp parallel
+        {
+            // Thread-local neighbor buffer (each thread gets its own)
+            std::vector<int> neighbors;
+            neighbors.reserve(100);
+            uint64_t queryNs = 0;
+            PerfCounters::Scope counters(PerfCounters::FORCES);
+            // Timed per thread, so the profiler sees how evenly the work spread
+            Profiler::Scope forcesZone(Profiler::FORCES);
+            
+            // No barrier here, so waiting threads do not count spin cycles;
+            // the end of the parallel region still waits for all of them
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (size_t i = 0; i < n; ++i) {
+                neighbors.clear();
+                
+                const float px = particles[i].x;
+                const float py = particles[i].y;
+                const int ptype = particles[i].type;
+                
+                const uint64_t queryStart = i % QUERY_SAMPLE_INTERVAL == 0 ? Profiler::now() : 0;
+                if (config.useSpatialHash) {
+                    queryNeighbors(px, py, neighbors);
+                    #pragma omp atomic
+                    metrics.spatialQueries++;
+                } else {
+                    // Brute force: check all particles
+                    neighbors.reserve(n);
+                    for (size_t j = 0; j < n; ++j) {
+                        neighbors.push_back(j);
+                    }
+                }
+                if (queryStart != 0) {
+                    queryNs += Profiler::now() - queryStart;
+                }
+                
+                float force_x = 0.0f;
+                float force_y = 0.0f;
+                int localForceCalculations = 0;
+                
+                // Vectorized inner loop - compiler can auto-vectorize this
+                for (size_t idx = 0; idx < neighbors.size(); ++idx) {
+                    const int j = neighbors[idx];
+                    if (i == static_cast<size_t>(j)) continue;
+                    
+                    // Calculate delta (vectorizable)
+                    float dx, dy;
+                    if (config.boundaryMode == WRAP) {
+                        dx = particles[j].x - px;
+                        dy = particles[j].y - py;
+                        // Nearest image in the 2-wide world
+                        if (dx > 1.0f) dx -= 2.0f;
+                        else if (dx < -1.0f) dx += 2.0f;
+                        if (dy > 1.0f) dy -= 2.0f;
+                        else if (dy < -1.0f) dy += 2.0f;
+                    } else {
+                        dx = particles[j].x - px;
+                        dy = particles[j].y - py;
+                    }
+                    
+                    const float distSq = dx * dx + dy * dy;
+                    
+                    // Branchless distance check using masking
+                    const bool inRange = (distSq > 0.00001f) && (distSq < radiusSq);
+                    if (inRange) {
+                        const float invDist = 1.0f / std::sqrt(distSq);
+                        const float dist = distSq * invDist;
+                        const float normDist = dist * invRadius;
+                        
+                        const float attraction = forces[ptype][particles[j].type];
+                        const float force = forceProfile(normDist, attraction) * forceFactor;
+                        
+                        force_x += dx * invDist * force;
+                        force_y += dy * invDist * force;
+                        localForceCalculations++;
+                    }
+                }
+                
+                // One shared update per particle instead of one per interaction
+                #pragma omp atomic
+                metrics.forceCalculations += localForceCalculations;
+                
+                // Mouse interaction (done serially, not in parallel section)
+                if (config.mousePressed) {
+                    const float dx = config.mouseX - px;
+                    const float dy = config.mouseY - py;
+                    const float distSq = dx * dx + dy * dy;
+                    const float mouseRadiusSq = config.mouseRadius * config.mouseRadius;
+                    
+                    if (distSq < mouseRadiusSq && distSq > 0.00001f) {
+                        const float invDist = 1.0f / std::sqrt(distSq);
+                        const float dist = distSq * invDist;
+                        const float strength = (1.0f - dist / config.mouseRadius);
+                        const float forceMagnitude = config.mouseForce * strength * invDist;
+                        
+                        force_x += dx * forceMagnitude;
+                        force_y += dy * forceMagnitude;
+                    }
+                }
+                
+                forceX[i] = force_x;
+                forceY[i] = force_y;
+            }
+            forcesZone.stop();
+            counters.stop();
+            
+            if (queryNs != 0) {
+                Profiler::instance().record(Profiler::NEIGHBOR_QUERY, queryNs * QUERY_SAMPLE_INTERVAL);
+            }
+        }
+    } else {
+        // Sequential processing for small particle counts (more stable)
+        std::vector<int> neighbors;
+        neighbors.reserve(100);
+        uint64_t queryNs = 0;
+        PerfCounters::Scope counters(PerfCounters::FORCES);
+        Profiler::Scope forcesZone(Profiler::FORCES);
+        
+        for (size_t i = 0; i < n; ++i) {
+            neighbors.clear();
+            
+            const float px = particles[i].x;
+            const float py = particles[i].y;
+            const int ptype = particles[i].type;
+        
+            const uint64_t queryStart = i % QUERY_SAMPLE_INTERVAL == 0 ? Profiler::now() : 0;
+            if (config.useSpatialHash) {
+                queryNeighbors(px, py, neighbors);
+                metrics.spatialQueries++;
+            } else {
+                // Brute force: check all particles
+                neighbors.reserve(n);
+                for (size_t j = 0; j < n; ++j) {
+                    neighbors.push_back(j);
+                }
+            }
+            if (queryStart != 0) {
+                queryNs += Profiler::now() - queryStart;
+            }
+            
+            float force_x = 0.0f;
+            float force_y = 0.0f;
+            
+            // Vectorized inner loop
+            for (size_t idx = 0; idx < neighbors.size(); ++idx) {
+                const int j = neighbors[idx];
+                if (i == static_cast<size_t>(j)) continue;
+                
+                float dx, dy;
+                if (config.boundaryMode == WRAP) {
+                    dx = particles[j].x - px;
+                    dy = particles[j].y - py;
+                    if (dx > 1.0f) dx -= 2.0f;
+                    else if (dx < -1.0f) dx += 2.0f;
+                    if (dy > 1.0f) dy -= 2.0f;
+                    else if (dy < -1.0f) dy += 2.0f;
+                } else {
+                    dx = particles[j].x - px;
+                    dy = particles[j].y - py;
+                }
+                
+                const float distSq = dx * dx + dy * dy;
+                
+                const bool inRange = (distSq > 0.00001f) && (distSq < radiusSq);
+                if (inRange) {
+                    const float invDist = 1.0f / std::sqrt(distSq);
+                    const float dist = distSq * invDist;
+                    const float normDist = dist * invRadius;
+                    
+                    const float attraction = forces[ptype][particles[j].type];
+                    const float force = forceProfile(normDist, attraction) * forceFactor;
+                    
+                    force_x += dx * invDist * force;
+                    force_y += dy * invDist * force;
+                    metrics.forceCalculations++;
+                }
+            }
+            
+            // Mouse interaction
+            if (config.mousePressed) {
+                const float dx = config.mouseX - px;
+                const float dy = config.mouseY - py;
+                const float distSq = dx * dx + dy * dy;
+                const float mouseRadiusSq = config.mouseRadius * config.mouseRadius;
+                
+                if (distSq < mouseRadiusSq && distSq > 0.00001f) {
+                    const float invDist = 1.0f / std::sqrt(distSq);
+                    const float dist = distSq * invDist;
+                    const float strength = (1.0f - dist / config.mouseRadius);
+                    const float forceMagnitude = config.mouseForce * strength * invDist;
+                    
+                    force_x += dx * forceMagnitude;
+                    force_y += dy * forceMagnitude;
+                }
+            }
+            
+            forceX[i] = force_x;
+            forceY[i] = force_y;
+        }
+        forcesZone.stop();
+        counters.stop();
+        
+        if (queryNs != 0) {
+            Profiler::instance().record(Profiler::NEIGHBOR_QUERY, queryNs * QUERY_SAMPLE_INTERVAL);
+        }
+    }
+    PerfCounters::instance().countParticles(PerfCounters::FORCES, n);
+}
+
+template <bool Strict>
+void ParticleSystem::integrateKernel(float dt) {
+    Profiler::Scope zone(Profiler::INTEGRATE);
+    pendingRemovals.clear();
+    
+    const size_t n = particles.size();
+    // Benchmarks may integrate without a snapshot to keep in step
+    const bool trackPrevious = previousPositions.size() == 2 * n;
+    
+    const float frictionFactor = config.friction;
+    const float maxSpeedSq = config.maxSpeed * config.maxSpeed;
+    
+    // This loop can be auto-vectorized by the compiler with -O3 -march=native
+    #pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        // Velocity update with force application
+        particles[i].vx += forceX[i] * dt;
+        particles[i].vy += forceY[i] * dt;
+        
+        // Apply friction
+        particles[i].vx *= frictionFactor;
+        particles[i].vy *= frictionFactor;
+        
+        // Speed limiting (branchless where possible)
+        const float speedSq = particles[i].vx * particles[i].vx + particles[i].vy * particles[i].vy;
+        if (speedSq > maxSpeedSq) {
+            const float invSpeed = 1.0f / std::sqrt(speedSq);
+            const float speedLimit = config.maxSpeed * invSpeed;
+            particles[i].vx *= speedLimit;
+            particles[i].vy *= speedLimit;
+        }
+        
+    // Advance one step.
+    particles[i].x += particles[i].vx * dt;
+    particles[i].y += particles[i].vy * dt;
+        
+        // Boundary handling - use fixed ±0.99 to keep particles cleanly inside viewport
+        const float boundary = 0.99f;  // Slightly inset for clean edges
+        const float damping = 0.8f;
+        
+        if (config.boundaryMode == WRAP) {
+            // Instant wrapping
+            const float oldX = particles[i].x;
+            const float oldY = particles[i].y;
+            if (particles[i].x < -boundary) particles[i].x = boundary - 0.001f;
+            else if (particles[i].x > boundary) particles[i].x = -boundary + 0.001f;
+            if (particles[i].y < -boundary) particles[i].y = boundary - 0.001f;
+            else if (particles[i].y > boundary) particles[i].y = -boundary + 0.001f;
+            if (trackPrevious && (particles[i].x != oldX || particles[i].y != oldY)) {
+                // Snap instead of interpolating across the whole world
+                previousPositions[2 * i] = particles[i].x;
+                previousPositions[2 * i + 1] = particles[i].y;
+            }
+        } else if (config.boundaryMode == BOUNCE) {
+            // Hard bounce at boundary
+            if (particles[i].x < -boundary) {
+                particles[i].x = -boundary;
+                particles[i].vx = std::abs(particles[i].vx) * damping;
+            } else if (particles[i].x > boundary) {
+                particles[i].x = boundary;
+                particles[i].vx = -std::abs(particles[i].vx) * damping;
+            }
+            
+            if (particles[i].y < -boundary) {
+                particles[i].y = -boundary;
+                particles[i].vy = std::abs(particles[i].vy) * damping;
+            } else if (particles[i].y > boundary) {
+                particles[i].y = boundary;
+                particles[i].vy = -std::abs(particles[i].vy) * damping;
+            }
+        } else if (config.boundaryMode == KILL) {
+            if (particles[i].x < -boundary || particles[i].x > boundary ||
+                particles[i].y < -boundary || particles[i].y > boundary) {
+                pendingRemovals.push_back(i);
+            }
+        }
+    }
+}
@@ -0,0 +1,7 @@
+// ParticleSystem's kernels for deterministic mode. CMake compiles this file
+// without fast math and without FMA contraction, so float sums keep their
+// source order whatever the vectoriser, alignment or thread count
+#include "ParticleSystemKernels.inl"
+
+template void ParticleSystem::computeForcesKernel<true>();
+template void ParticleSystem::integrateKernel<true>(float dt);
@@ -1,4 +1,7 @@
 #include "ui/Interface.h"
+#include "rendering/QualityGovernor.h"
+#include "util/FramePacer.h"
+#include "util/Profiler.h"
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <algorithm>
@@ -421,7 +424,9 @@ void Interface::renderMainControlPanel() {
         const auto& metrics = particleSystem.getMetrics();
         const auto& particles = particleSystem.getParticles();
         
-        float fps = metrics.averageFPS;
+        // Rendered frames and simulation steps are counted separately: they
+        // only match in VSync mode at the default step rate
+        float fps = framePacer ? framePacer->getFramesPerSecond() : 0.0f;
         ImVec4 fpsColor = fps > 50 ? ImVec4(0.2f, 1.0f, 0.3f, 1.0f) : 
                           fps > 30 ? ImVec4(1.0f, 1.0f, 0.2f, 1.0f) : 
                           ImVec4(1.0f, 0.2f, 0.2f, 1.0f);
@@ -437,16 +442,63 @@ void Interface::renderMainControlPanel() {
         ImGui::ProgressBar(fpsNormalized, ImVec2(-1, 0), "");
         ImGui::PopStyleColor();
         
+        ImGui::Text("Simulation: %.1f steps/s", metrics.stepsPerSecond);
+        
+        if (framePacer) {
+            FramePacer::Config& pacing = framePacer->getConfig();
+            ImGui::PushItemWidth(-1);
+            if (ImGui::BeginCombo("##Pacing", FramePacer::modeName(pacing.mode))) {
+                for (int i = FramePacer::VSYNC; i <= FramePacer::SIM_MAX_RENDER_30; ++i) {
+                    const auto mode = static_cast<FramePacer::Mode>(i);
+                    if (ImGui::Selectable(FramePacer::modeName(mode), pacing.mode == mode)) {
+                        pacing.mode = mode;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("VSync: fixed steps, display-locked frames\n"
+                                  "Uncapped: one step per frame, as fast as possible\n"
+                                  "Fixed Step: fixed step rate, frames as fast as possible\n"
+                                  "Max Sim: step as fast as possible, draw at 30 Hz");
+            }
+            if (pacing.mode == FramePacer::VSYNC || pacing.mode == FramePacer::FIXED_INTERPOLATED) {
+                ImGui::SliderFloat("##StepRate", &pacing.stepRate, 15.0f, 240.0f, "Step rate: %.0f Hz");
+            }
+            ImGui::PopItemWidth();
+        }
+        
+        if (governor) {
+            QualityGovernor::Config& quality = governor->getConfig();
+            ImGui::Checkbox("🎚 Auto Quality", &quality.enabled);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Lower trail resolution, drawn particles, detail and step rate\n"
+                                  "to stay within the frame budget; restores them when there is headroom");
+            }
+            if (quality.enabled) {
+                ImGui::PushItemWidth(-1);
+                ImGui::SliderFloat("##Budget", &quality.budgetMs, 4.0f, 50.0f, "Budget: %.1f ms");
+                ImGui::PopItemWidth();
+                ImGui::Text("Render level %d/%d, sim level %d/%d",
+                            governor->getRenderLevel(), QualityGovernor::MAX_RENDER_LEVEL,
+                            governor->getSimLevel(), QualityGovernor::MAX_SIM_LEVEL);
+                if (!governor->getLastDecision().empty()) {
+                    ImGui::TextWrapped("%s", governor->getLastDecision().c_str());
+                }
+            }
+        }
+        
         ImGui::Separator();
         ImGui::Text("🔢 Particle Count: %zu", particles.size());
         ImGui::Text("⚙️ Update Time: %.2f ms", metrics.updateTimeMs);
-        ImGui::Text("🎨 Render Time: %.2f ms", metrics.renderTimeMs);
+        const float renderTimeMs = framePacer ? framePacer->getRenderTimeMs() : 0.0f;
+        ImGui::Text("🎨 Render Time: %.2f ms", renderTimeMs);
         
-        float totalTime = metrics.updateTimeMs + metrics.renderTimeMs;
+        float totalTime = metrics.updateTimeMs + renderTimeMs;
         ImGui::Spacing();
         ImGui::Text("Total Frame: %.2f ms", totalTime);
         if (ImGui::IsItemHovered()) {
-            ImGui::SetTooltip("Target: 16.67ms for 60 FPS");
+            ImGui::SetTooltip("One step plus one frame\nTarget: 16.67ms for 60 FPS");
         }
     }
     
@@ -484,6 +536,107 @@ void Interface::renderMainControlPanel() {
             ImGui::Unindent();
         }
         
+        ImGui::Checkbox("📏 Size by Speed", &renderConfig.sizeBySpeed);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Faster particles are drawn larger");
+        }
+
+        if (renderConfig.sizeBySpeed) {
+            ImGui::Indent();
+            ImGui::Text("Size Range:");
+            ImGui::SliderFloat("##MinParticleSize", &renderConfig.minParticleSize, 1.0f, 32.0f, "%.0f px");
+            ImGui::SliderFloat("##MaxParticleSize", &renderConfig.maxParticleSize, 1.0f, 128.0f, "%.0f px");
+            ImGui::Unindent();
+        }
+
+        ImGui::Checkbox("➡ Velocity Vectors", &renderConfig.showVelocityVectors);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw a line along each particle's velocity");
+        }
+
+        if (renderConfig.showVelocityVectors) {
+            ImGui::Indent();
+            ImGui::Text("Vector Length:");
+            ImGui::SliderFloat("##VectorLength", &renderConfig.velocityVectorLength, 0.005f, 0.2f, "%.3f");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Line length at maximum speed (world units)");
+            }
+            ImGui::Unindent();
+        }
+
+        ImGui::Checkbox("🔲 Instanced Quads", &renderConfig.instancedQuads);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw each particle as an instanced quad\nOff = GL_POINTS (size limited by the driver)");
+        }
+
+        ImGui::Checkbox("☄ Particle Trails", &renderConfig.enableTrails);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Accumulate particles into a fading history buffer");
+        }
+
+        if (renderConfig.enableTrails) {
+            ImGui::Indent();
+            ImGui::Text("Trail Length:");
+            ImGui::SliderFloat("##TrailIntensity", &renderConfig.trailIntensity, 0.5f, 0.99f, "%.2f");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Fraction of the previous frame kept each frame");
+            }
+            ImGui::Checkbox("Half Resolution", &renderConfig.halfResolutionTrails);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Accumulate trails at half size to save fill rate");
+            }
+            ImGui::Unindent();
+        }
+
+        ImGui::Checkbox("🔥 Density Heatmap", &renderConfig.densityMode);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw particle density per type instead of individual particles\nCost no longer grows with particle count");
+        }
+
+        if (renderConfig.densityMode) {
+            ImGui::Indent();
+            ImGui::Text("Grid Resolution:");
+            ImGui::SliderInt("##DensityResolution", &renderConfig.densityResolution, 64, 512);
+            ImGui::Text("Exposure:");
+            ImGui::SliderFloat("##DensityExposure", &renderConfig.densityExposure, 0.05f, 4.0f, "%.2f");
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Brightness relative to the average particles per cell");
+            }
+            ImGui::Unindent();
+        }
+
+        Camera& camera = renderer.getCamera();
+        ImGui::Text("Camera: %.2fx", camera.getZoom());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##Camera")) {
+            camera.reset();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Scroll to zoom, Shift + drag to pan, C to reset");
+        }
+        ImGui::Checkbox("✂ Cull to View", &renderConfig.cullToView);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("When zoomed in, upload only particles in visible grid cells");
+        }
+
+        ImGui::Checkbox("📦 Compact Vertices", &renderConfig.compactVertices);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Quantise particles to 8 bytes before upload\nOff = upload simulation arrays directly (no CPU copy)");
+        }
+        
+        bool hotReload = renderer.isShaderHotReloadEnabled();
+        if (ImGui::Checkbox("🔁 Hot-reload Shaders", &hotReload)) {
+            renderer.setShaderHotReload(hotReload);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Rebuild shaders when files in %s change\nA shader that fails to compile keeps the previous version",
+                              renderer.getShaderDirectory().c_str());
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reload##Shaders")) {
+            renderer.reloadShaders();
+        }
+        
         ImGui::PopItemWidth();
         ImGui::PopID();
     }
@@ -621,6 +774,19 @@ void Interface::renderMainControlPanel() {
             ImGui::SetTooltip("Zero all forces\nParticles drift freely");
         }
         
+        ImGui::Checkbox("Deterministic", &config.deterministic);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Resets and presets replay from the seed\nShows a state hash per step in the HUD");
+        }
+        if (config.deterministic) {
+            ImGui::SameLine();
+            int seed = static_cast<int>(config.seed);
+            ImGui::SetNextItemWidth(100);
+            if (ImGui::InputInt("Seed", &seed)) {
+                config.seed = static_cast<uint32_t>(std::max(seed, 0));
+            }
+        }
+        
         ImGui::Spacing();
         ImGui::Text("Motion Control:");
         ImGui::Spacing();
@@ -667,25 +833,163 @@ void Interface::renderPerformanceHUD() {
     if (!showPerformanceHUD) return;
     
     ImGui::SetNextWindowPos(ImVec2(440, 20), ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(ImVec2(200, 140), ImGuiCond_FirstUseEver);
     ImGui::SetNextWindowBgAlpha(0.8f);
     
-    ImGuiWindowFlags flags = ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse;
+    ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse;
     if (ImGui::Begin("Performance", &showPerformanceHUD, flags)) {
         const auto& metrics = particleSystem.getMetrics();
         const auto& particles = particleSystem.getParticles();
         
-        float fps = metrics.averageFPS;
+        float fps = framePacer ? framePacer->getFramesPerSecond() : 0.0f;
         ImVec4 fpsColor = fps > 50 ? ImVec4(0,1,0,1) : fps > 30 ? ImVec4(1,1,0,1) : ImVec4(1,0,0,1);
         
         ImGui::TextColored(fpsColor, "FPS: %.1f", fps);
+        ImGui::Text("Steps/s: %.1f", metrics.stepsPerSecond);
         ImGui::Text("Particles: %zu", particles.size());
         ImGui::Text("Update: %.2fms", metrics.updateTimeMs);
-        ImGui::Text("Render: %.2fms", metrics.renderTimeMs);
+        if (particleSystem.getConfig().deterministic) {
+            ImGui::Text("State hash: %016llx", static_cast<unsigned long long>(metrics.stateHash));
+        }
+        ImGui::Text("Render: %.2fms", framePacer ? framePacer->getRenderTimeMs() : 0.0f);
+        
+        Profiler& profiler = Profiler::instance();
+        bool profiling = profiler.isEnabled();
+        if (ImGui::Checkbox("Zone Profiler", &profiling)) {
+            profiler.setEnabled(profiling);
+        }
+        if (profiling) {
+            renderProfilerZones(profiler);
+            ImGui::TextDisabled(profiler.isTracePending() ? "Tracing..." : "T: save trace, Shift+T: trace ahead");
+        }
+        
+        renderPerfCounters();
     }
     ImGui::End();
 }
 
+void Interface::renderPerfCounters() {
+    PerfCounters& counters = PerfCounters::instance();
+    bool enabled = counters.isEnabled();
+    if (ImGui::Checkbox("Hardware Counters", &enabled)) {
+        counters.setEnabled(enabled);
+        counters.reset();
+        perfStats = {};
+        perfCollectTime = ImGui::GetTime();
+    }
+    if (!enabled) return;
+    if (!counters.isAvailable()) {
+        ImGui::TextDisabled("Unavailable: %s", counters.getError().c_str());
+        return;
+    }
+    
+    const double now = ImGui::GetTime();
+    if (now - perfCollectTime >= 0.5) {
+        counters.collect(perfStats);
+        perfCollectTime = now;
+    }
+    
+    // Misses are per particle per step
+    if (ImGui::BeginTable("##Counters", 5, ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Region");
+        ImGui::TableSetupColumn("IPC");
+        ImGui::TableSetupColumn("L1D/p");
+        ImGui::TableSetupColumn("LLC/p");
+        ImGui::TableSetupColumn("Br/p");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < PerfCounters::REGION_COUNT; ++i) {
+            const PerfCounters::RegionStats& stats = perfStats[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", PerfCounters::regionName(static_cast<PerfCounters::Region>(i)));
+            if (!stats.valid) continue;
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.ipc());
+            for (PerfCounters::Counter counter : {PerfCounters::L1D_MISSES, PerfCounters::LLC_MISSES,
+                                                  PerfCounters::BRANCH_MISSES}) {
+                ImGui::TableNextColumn();
+                if (stats.supported[counter]) {
+                    ImGui::Text("%.2f", stats.perParticle(counter));
+                } else {
+                    ImGui::TextDisabled("n/a");
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void Interface::renderProfilerZones(const Profiler& profiler) {
+    static const ImU32 zoneColors[Profiler::ZONE_COUNT] = {
+        IM_COL32(120, 200, 255, 255), // Grid build
+        IM_COL32(255, 140, 60, 255),  // Forces
+        IM_COL32(255, 210, 80, 255),  // Neighbour query
+        IM_COL32(120, 230, 120, 255), // Integrate
+        IM_COL32(200, 120, 255, 255), // Compaction
+        IM_COL32(150, 150, 255, 255), // Create particles
+        IM_COL32(255, 110, 170, 255), // Vertex build
+        IM_COL32(90, 230, 210, 255),  // Upload
+        IM_COL32(240, 90, 90, 255),   // Draw
+        IM_COL32(180, 180, 180, 255)  // ImGui
+    };
+    
+    if (ImGui::BeginTable("##Zones", 4, ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < Profiler::ZONE_COUNT; ++i) {
+            const auto zone = static_cast<Profiler::Zone>(i);
+            const Profiler::ZoneStats stats = profiler.getStats(zone);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            // Nested zones are indented under their parent
+            if (Profiler::zoneParent(zone) != Profiler::ZONE_COUNT) ImGui::Indent();
+            ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(zoneColors[i]), "%s", Profiler::zoneName(zone));
+            if (Profiler::zoneParent(zone) != Profiler::ZONE_COUNT) ImGui::Unindent();
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.p50Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.p95Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats.p99Ms);
+        }
+        ImGui::EndTable();
+    }
+    
+    // Stacked self times per frame, newest on the right
+    const size_t frames = profiler.getFrameCount();
+    float maxTotal = 1.0f;
+    for (size_t frame = 0; frame < frames; ++frame) {
+        float total = 0.0f;
+        for (int i = 0; i < Profiler::ZONE_COUNT; ++i) {
+            total += profiler.getSelfMs(static_cast<Profiler::Zone>(i), frame);
+        }
+        maxTotal = std::max(maxTotal, total);
+    }
+    
+    const ImVec2 size(280.0f, 80.0f);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(20, 20, 25, 200));
+    
+    const float columnWidth = size.x / static_cast<float>(Profiler::HISTORY);
+    const float pixelsPerMs = size.y / maxTotal;
+    const float firstColumn = origin.x + size.x - columnWidth * static_cast<float>(frames);
+    for (size_t frame = 0; frame < frames; ++frame) {
+        const float x0 = firstColumn + columnWidth * static_cast<float>(frame);
+        float y = origin.y + size.y;
+        for (int i = 0; i < Profiler::ZONE_COUNT; ++i) {
+            const float height = profiler.getSelfMs(static_cast<Profiler::Zone>(i), frame) * pixelsPerMs;
+            if (height <= 0.0f) continue;
+            drawList->AddRectFilled(ImVec2(x0, y - height), ImVec2(x0 + columnWidth, y), zoneColors[i]);
+            y -= height;
+        }
+    }
+    ImGui::Dummy(size);
+    ImGui::Text("Scale: %.1f ms", maxTotal);
+}
+
 // All old functions disabled
 void Interface::renderStatus() {}
 void Interface::renderMainControls() {}
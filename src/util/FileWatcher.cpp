@@ -0,0 +1,89 @@
+#include "util/FileWatcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+static constexpr std::chrono::milliseconds SETTLE_TIME(100);
+static constexpr std::chrono::milliseconds SCAN_INTERVAL(500);
+
+FileWatcher::FileWatcher(const std::string& dir)
+    : directory(dir), inotifyFd(-1), pending(false) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        // Editors often save by writing a new file and renaming it over the
+        // old one, so watch the directory rather than the individual files
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+        if (inotify_add_watch(inotifyFd, directory.c_str(), mask) < 0) {
+            std::cerr << "inotify watch failed for " << directory << ", polling instead" << std::endl;
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+    }
+#endif
+    if (inotifyFd < 0) {
+        scanModificationTimes();
+        lastScan = std::chrono::steady_clock::now();
+    }
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+bool FileWatcher::readEvents() {
+    bool changed = false;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) break; // EAGAIN: queue drained
+        changed = true;
+    }
+#endif
+    return changed;
+}
+
+bool FileWatcher::scanModificationTimes() {
+    std::map<std::string, std::filesystem::file_time_type> current;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error)) {
+            current[it->path().string()] = it->last_write_time(error);
+        }
+    }
+    
+    const bool changed = current != modificationTimes;
+    modificationTimes.swap(current);
+    return changed;
+}
+
+bool FileWatcher::poll() {
+    const auto now = std::chrono::steady_clock::now();
+    
+    bool changed = false;
+    if (inotifyFd >= 0) {
+        changed = readEvents();
+    } else if (now - lastScan >= SCAN_INTERVAL) {
+        changed = scanModificationTimes();
+        lastScan = now;
+    }
+    
+    if (changed) {
+        pending = true;
+        lastChange = now;
+    }
+    if (pending && now - lastChange >= SETTLE_TIME) {
+        pending = false;
+        return true;
+    }
+    return false;
+}
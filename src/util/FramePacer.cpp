@@ -0,0 +1,72 @@
+#include "util/FramePacer.h"
+#include <algorithm>
+
+// The simulation is tuned for 1/60 s steps; modes that decouple stepping
+// from wall-clock time keep that step size
+static constexpr double FREE_RUNNING_STEP = 1.0 / 60.0;
+
+const char* FramePacer::modeName(Mode mode) {
+    switch (mode) {
+        case VSYNC: return "VSync";
+        case UNCAPPED: return "Uncapped";
+        case FIXED_INTERPOLATED: return "Fixed Step + Interpolation";
+        case SIM_MAX_RENDER_30: return "Max Sim, Render 30 Hz";
+    }
+    return "Unknown";
+}
+
+FramePacer::FramePacer()
+    : lastTime(0.0), accumulator(0.0), lastRenderTime(0.0), started(false), renderTimeMs(0.0f) {
+}
+
+double FramePacer::getStepDelta() const {
+    switch (config.mode) {
+        case UNCAPPED:
+        case SIM_MAX_RENDER_30:
+            return FREE_RUNNING_STEP;
+        default:
+            return 1.0 / std::max(config.stepRate, 1.0f);
+    }
+}
+
+int FramePacer::beginFrame(double now) {
+    if (!started) {
+        lastTime = now;
+        lastRenderTime = now - SIM_MAX_RENDER_INTERVAL;
+        started = true;
+    }
+    const double frameTime = std::min(now - lastTime, static_cast<double>(config.maxFrameTime));
+    lastTime = now;
+    
+    if (config.mode == UNCAPPED || config.mode == SIM_MAX_RENDER_30) {
+        accumulator = 0.0;
+        return 1;
+    }
+    
+    const double stepDelta = getStepDelta();
+    accumulator = std::min(accumulator + frameTime, static_cast<double>(config.maxFrameTime));
+    int steps = 0;
+    while (accumulator >= stepDelta) {
+        accumulator -= stepDelta;
+        ++steps;
+    }
+    return steps;
+}
+
+bool FramePacer::shouldRender(double now) const {
+    if (config.mode == SIM_MAX_RENDER_30) {
+        return now - lastRenderTime >= SIM_MAX_RENDER_INTERVAL;
+    }
+    return true;
+}
+
+void FramePacer::frameRendered(double now, float timeMs) {
+    lastRenderTime = now;
+    renderTimeMs = timeMs;
+    frameRate.tick();
+}
+
+float FramePacer::getInterpolationAlpha() const {
+    if (config.mode != FIXED_INTERPOLATED) return 1.0f;
+    return static_cast<float>(std::clamp(accumulator / getStepDelta(), 0.0, 1.0));
+}
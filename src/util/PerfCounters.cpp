@@ -0,0 +1,220 @@
+#include "util/PerfCounters.h"
+#include <iostream>
+
+#ifdef PARTICLELIFE_HAS_PERF
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+// One counter group per thread, led by the cycle counter. Counters the CPU
+// or hypervisor does not offer are left out of the group.
+struct ThreadGroup {
+    bool opened = false;
+    int leader = -1;
+    int members = 0;
+    std::array<int, PerfCounters::COUNTER_COUNT> fds;
+    std::array<int, PerfCounters::COUNTER_COUNT> slots; // Position in a group read, -1 if missing
+
+    ThreadGroup() {
+        fds.fill(-1);
+        slots.fill(-1);
+    }
+    ~ThreadGroup() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+};
+
+thread_local ThreadGroup threadGroup;
+
+int openCounter(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+uint64_t readMissConfig(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+bool openGroup(ThreadGroup& group, std::string& reason) {
+    group.opened = true;
+    const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[PerfCounters::COUNTER_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, readMissConfig(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, readMissConfig(PERF_COUNT_HW_CACHE_LL)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter) {
+        const int fd = openCounter(events[counter].type, events[counter].config, group.leader);
+        if (fd < 0) {
+            if (counter != PerfCounters::CYCLES) continue;
+
+            const int error = errno;
+            reason = std::string("perf_event_open: ") + std::strerror(error);
+            if (error == EACCES || error == EPERM) {
+                reason += " (see /proc/sys/kernel/perf_event_paranoid)";
+            } else if (error == ENOENT || error == ENODEV || error == EOPNOTSUPP) {
+                reason += " (no hardware PMU, e.g. inside a VM)";
+            }
+            return false;
+        }
+        if (counter == PerfCounters::CYCLES) group.leader = fd;
+        group.fds[counter] = fd;
+        group.slots[counter] = group.members++;
+    }
+    return true;
+}
+
+bool readGroup(const ThreadGroup& group, std::array<uint64_t, PerfCounters::COUNTER_COUNT>& values,
+               uint64_t& enabled, uint64_t& running) {
+    // nr, time enabled, time running, then one value per member
+    uint64_t buffer[3 + PerfCounters::COUNTER_COUNT];
+    const ssize_t expected = static_cast<ssize_t>((3 + group.members) * sizeof(uint64_t));
+    if (read(group.leader, buffer, sizeof(buffer)) < expected) return false;
+
+    enabled = buffer[1];
+    running = buffer[2];
+    for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; ++counter) {
+        values[counter] = group.slots[counter] >= 0 ? buffer[3 + group.slots[counter]] : 0;
+    }
+    return true;
+}
+
+} // namespace
+#endif
+
+const char* PerfCounters::counterName(Counter counter) {
+    switch (counter) {
+        case CYCLES: return "Cycles";
+        case INSTRUCTIONS: return "Instructions";
+        case L1D_MISSES: return "L1D misses";
+        case LLC_MISSES: return "LLC misses";
+        case BRANCH_MISSES: return "Branch misses";
+        case COUNTER_COUNT: break;
+    }
+    return "Unknown";
+}
+
+const char* PerfCounters::regionName(Region region) {
+    switch (region) {
+        case GRID_BUILD: return "Grid build";
+        case FORCES: return "Forces";
+        case REGION_COUNT: break;
+    }
+    return "Unknown";
+}
+
+double PerfCounters::RegionStats::ipc() const {
+    if (!supported[CYCLES] || !supported[INSTRUCTIONS] || values[CYCLES] <= 0.0) return 0.0;
+    return values[INSTRUCTIONS] / values[CYCLES];
+}
+
+double PerfCounters::RegionStats::perParticle(Counter counter) const {
+    return particles > 0 ? values[counter] / static_cast<double>(particles) : 0.0;
+}
+
+PerfCounters::PerfCounters() : enabled(false), failed(false) {
+#ifndef PARTICLELIFE_HAS_PERF
+    failed = true;
+    error = "built without perf_event_open support";
+#endif
+}
+
+PerfCounters& PerfCounters::instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+void PerfCounters::fail(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (failed.exchange(true)) return;
+    error = reason;
+    std::cerr << "Hardware counters unavailable: " << reason << std::endl;
+}
+
+bool PerfCounters::isAvailable() {
+    if (failed.load(std::memory_order_relaxed)) return false;
+#ifdef PARTICLELIFE_HAS_PERF
+    if (!threadGroup.opened) {
+        std::string reason;
+        if (!openGroup(threadGroup, reason)) {
+            fail(reason);
+            return false;
+        }
+    }
+    return threadGroup.leader >= 0;
+#else
+    return false;
+#endif
+}
+
+std::string PerfCounters::getError() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return error;
+}
+
+PerfCounters::Scope::Scope(Region region)
+    : region(region), active(false), start{}, startEnabled(0), startRunning(0) {
+#ifdef PARTICLELIFE_HAS_PERF
+    PerfCounters& counters = instance();
+    if (!counters.isEnabled() || !counters.isAvailable()) return;
+    active = readGroup(threadGroup, start, startEnabled, startRunning);
+#endif
+}
+
+void PerfCounters::Scope::stop() {
+    if (!active) return;
+    active = false;
+#ifdef PARTICLELIFE_HAS_PERF
+    std::array<uint64_t, COUNTER_COUNT> end;
+    uint64_t endEnabled, endRunning;
+    if (!readGroup(threadGroup, end, endEnabled, endRunning)) return;
+
+    // The kernel multiplexes groups that do not fit the PMU; scale the
+    // counts up to the time the group was enabled
+    const uint64_t running = endRunning - startRunning;
+    if (running == 0) return;
+    const double scale = static_cast<double>(endEnabled - startEnabled) / static_cast<double>(running);
+
+    PerfCounters& counters = instance();
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        if (threadGroup.slots[counter] < 0) continue;
+        const double delta = static_cast<double>(end[counter] - start[counter]) * scale;
+        counters.totals[region][counter].fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed);
+        counters.seen[region][counter].store(true, std::memory_order_relaxed);
+    }
+#endif
+}
+
+void PerfCounters::collect(std::array<RegionStats, REGION_COUNT>& out) {
+    for (int region = 0; region < REGION_COUNT; ++region) {
+        RegionStats& stats = out[region];
+        for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+            stats.values[counter] = static_cast<double>(totals[region][counter].exchange(0, std::memory_order_relaxed));
+            stats.supported[counter] = seen[region][counter].exchange(false, std::memory_order_relaxed);
+        }
+        stats.particles = particles[region].exchange(0, std::memory_order_relaxed);
+        stats.valid = stats.supported[CYCLES];
+    }
+}
+
+void PerfCounters::reset() {
+    std::array<RegionStats, REGION_COUNT> discarded;
+    collect(discarded);
+}
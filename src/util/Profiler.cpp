@@ -0,0 +1,309 @@
+#include "util/Profiler.h"
+#include "util/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+static constexpr int ZONE_SHIFT = 56;
+static constexpr uint64_t DURATION_MASK = (uint64_t(1) << ZONE_SHIFT) - 1;
+
+static uint64_t clockNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+const char* Profiler::zoneName(Zone zone) {
+    switch (zone) {
+        case GRID_BUILD: return "Grid build";
+        case FORCES: return "Forces";
+        case NEIGHBOR_QUERY: return "Neighbour query";
+        case INTEGRATE: return "Integrate";
+        case COMPACTION: return "Compaction";
+        case CREATE_PARTICLES: return "Create particles";
+        case VERTEX_BUILD: return "Vertex build";
+        case UPLOAD: return "Upload";
+        case DRAW: return "Draw";
+        case UI: return "ImGui";
+        case ZONE_COUNT: break;
+    }
+    return "Unknown";
+}
+
+Profiler::Zone Profiler::zoneParent(Zone zone) {
+    return zone == NEIGHBOR_QUERY ? FORCES : ZONE_COUNT;
+}
+
+Profiler::Scope::Scope(Zone zone) : zone(zone), start(Profiler::now()) {
+}
+
+void Profiler::Scope::stop() {
+    if (start != 0) {
+        Profiler::instance().record(zone, Profiler::now() - start, start);
+        start = 0;
+    }
+}
+
+uint64_t Profiler::now() {
+    return instance().isEnabled() ? clockNanoseconds() : 0;
+}
+
+Profiler::Profiler()
+    : enabled(true), frames(0), next(0), droppedEvents(0),
+      traceFrames(TRACE_FRAMES), traceCount(0), traceNext(0), lastFrameEnd(0), mainThread(0),
+      pendingTraceFrames(0), pendingTraceRemaining(0) {
+}
+
+Profiler::~Profiler() = default;
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadRing& Profiler::threadRing() {
+    // Rings outlive their threads; OpenMP keeps its pool alive anyway
+    thread_local ThreadRing* ring = nullptr;
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<ThreadRing>());
+        ring = rings.back().get();
+    }
+    return *ring;
+}
+
+void Profiler::record(Zone zone, uint64_t nanoseconds, uint64_t start) {
+    ThreadRing& ring = threadRing();
+    const uint64_t index = ring.written.load(std::memory_order_relaxed);
+    Slot& slot = ring.events[index % ThreadRing::CAPACITY];
+    // Pairs with the fence in endFrame: a reader that sees these stores
+    // also sees `written` at index or later, and drops the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.packed.store((static_cast<uint64_t>(zone) << ZONE_SHIFT) | std::min(nanoseconds, DURATION_MASK),
+                      std::memory_order_relaxed);
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::endFrame() {
+    const uint64_t frameEnd = clockNanoseconds();
+    const ThreadRing* caller = &threadRing();
+    
+    TraceFrame& trace = traceFrames[traceNext];
+    trace.events.clear();
+    trace.start = lastFrameEnd != 0 ? lastFrameEnd : frameEnd;
+    trace.end = frameEnd;
+    
+    std::array<uint64_t, ZONE_COUNT> frameTotals{};
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threadTotals.resize(rings.size());
+        for (size_t thread = 0; thread < rings.size(); ++thread) {
+            ThreadRing& ring = *rings[thread];
+            if (&ring == caller) mainThread = thread;
+            
+            const uint64_t written = ring.written.load(std::memory_order_acquire);
+            if (written - ring.read > ThreadRing::CAPACITY) {
+                droppedEvents += written - ring.read - ThreadRing::CAPACITY;
+                ring.read = written - ThreadRing::CAPACITY;
+            }
+            
+            const size_t firstEvent = trace.events.size();
+            for (uint64_t index = ring.read; index < written; ++index) {
+                const Slot& slot = ring.events[index % ThreadRing::CAPACITY];
+                const uint64_t start = slot.start.load(std::memory_order_relaxed);
+                const uint64_t packed = slot.packed.load(std::memory_order_relaxed);
+                trace.events.push_back({static_cast<uint32_t>(thread), static_cast<uint32_t>(packed >> ZONE_SHIFT),
+                                        start, packed & DURATION_MASK});
+            }
+            
+            // Drop whatever the producer may have started overwriting meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = ring.written.load(std::memory_order_relaxed);
+            const uint64_t safeFrom = after >= ThreadRing::CAPACITY ? after - ThreadRing::CAPACITY + 1 : 0;
+            if (safeFrom > ring.read) {
+                const size_t torn = static_cast<size_t>(std::min(safeFrom, written) - ring.read);
+                trace.events.erase(trace.events.begin() + firstEvent, trace.events.begin() + firstEvent + torn);
+                droppedEvents += torn;
+            }
+            ring.read = written;
+            
+            std::array<uint64_t, ZONE_COUNT> ringTotals{};
+            for (size_t i = firstEvent; i < trace.events.size(); ++i) {
+                if (trace.events[i].zone < ZONE_COUNT) {
+                    ringTotals[trace.events[i].zone] += trace.events[i].duration;
+                }
+            }
+            for (size_t zone = 0; zone < ZONE_COUNT; ++zone) {
+                frameTotals[zone] = std::max(frameTotals[zone], ringTotals[zone]);
+                threadTotals[thread][zone] += ringTotals[zone];
+            }
+        }
+    }
+    
+    for (size_t zone = 0; zone < ZONE_COUNT; ++zone) {
+        history[zone][next] = static_cast<float>(frameTotals[zone] * 1e-6);
+    }
+    next = (next + 1) % HISTORY;
+    frames = std::min(frames + 1, HISTORY);
+    
+    traceNext = (traceNext + 1) % TRACE_FRAMES;
+    traceCount = std::min(traceCount + 1, TRACE_FRAMES);
+    lastFrameEnd = frameEnd;
+    
+    if (pendingTraceRemaining > 0 && --pendingTraceRemaining == 0) {
+        saveTrace(pendingTracePath, pendingTraceFrames);
+    }
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto& ring : rings) {
+        ring->read = ring->written.load(std::memory_order_acquire);
+    }
+    frames = next = 0;
+    traceCount = traceNext = 0;
+    lastFrameEnd = 0;
+    droppedEvents = 0;
+    threadTotals.clear();
+}
+
+std::vector<double> Profiler::getThreadMs(Zone zone) const {
+    std::vector<double> ms(threadTotals.size());
+    for (size_t thread = 0; thread < threadTotals.size(); ++thread) {
+        ms[thread] = threadTotals[thread][zone] * 1e-6;
+    }
+    return ms;
+}
+
+size_t Profiler::slot(size_t frame) const {
+    return (next + HISTORY - frames + frame) % HISTORY;
+}
+
+Profiler::ZoneStats Profiler::getStats(Zone zone) const {
+    ZoneStats stats;
+    if (frames == 0) return stats;
+    
+    std::vector<float> sorted(frames);
+    for (size_t frame = 0; frame < frames; ++frame) {
+        sorted[frame] = getFrameMs(zone, frame);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    
+    // Nearest rank
+    auto percentile = [&](float p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(frames)));
+        return sorted[std::clamp<size_t>(rank, 1, frames) - 1];
+    };
+    stats.p50Ms = percentile(0.50f);
+    stats.p95Ms = percentile(0.95f);
+    stats.p99Ms = percentile(0.99f);
+    return stats;
+}
+
+float Profiler::getSelfMs(Zone zone, size_t frame) const {
+    float self = getFrameMs(zone, frame);
+    for (int child = 0; child < ZONE_COUNT; ++child) {
+        if (zoneParent(static_cast<Zone>(child)) == zone) {
+            self -= getFrameMs(static_cast<Zone>(child), frame);
+        }
+    }
+    // Children are each thread's worst case, so they can exceed the parent
+    return std::max(self, 0.0f);
+}
+
+bool Profiler::saveTrace(const std::string& path, size_t frameCount) {
+    frameCount = std::min(frameCount, traceCount);
+    if (frameCount == 0) return false;
+    
+    // Copy now so later frames can reuse the ring; everything slow happens
+    // on the writer thread
+    std::vector<TraceFrame> snapshot;
+    snapshot.reserve(frameCount);
+    for (size_t i = 0; i < frameCount; ++i) {
+        snapshot.push_back(traceFrames[(traceNext + TRACE_FRAMES - frameCount + i) % TRACE_FRAMES]);
+    }
+    size_t threadCount;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threadCount = rings.size();
+    }
+    
+    if (!traceWriter) {
+        traceWriter = std::make_unique<WorkerPool>(1);
+    }
+    auto frameData = std::make_shared<std::vector<TraceFrame>>(std::move(snapshot));
+    const size_t main = mainThread;
+    traceWriter->submit([path, frameData, threadCount, main]() {
+        writeTrace(path, *frameData, threadCount, main);
+    });
+    return true;
+}
+
+void Profiler::traceNextFrames(const std::string& path, size_t frameCount) {
+    pendingTracePath = path;
+    pendingTraceFrames = std::clamp<size_t>(frameCount, 1, TRACE_FRAMES);
+    pendingTraceRemaining = pendingTraceFrames;
+}
+
+void Profiler::waitForTraces() {
+    if (traceWriter) {
+        traceWriter->waitIdle();
+    }
+}
+
+bool Profiler::writeTrace(const std::string& path, const std::vector<TraceFrame>& frames,
+                          size_t threadCount, size_t mainThread) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+    
+    uint64_t origin = frames.front().start;
+    for (const TraceFrame& frame : frames) {
+        for (const TraceEvent& event : frame.events) {
+            if (event.start != 0) origin = std::min(origin, event.start);
+        }
+    }
+    auto micros = [origin](uint64_t nanoseconds) { return static_cast<double>(nanoseconds - origin) * 1e-3; };
+    file << std::fixed << std::setprecision(3);
+    
+    // Track 0 holds the frames; every profiled thread gets the track after it
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Particle Life\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+    for (size_t thread = 0; thread < threadCount; ++thread) {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread + 1
+             << ",\"args\":{\"name\":\"";
+        if (thread == mainThread) {
+            file << "Main";
+        } else {
+            file << "Worker " << thread;
+        }
+        file << "\"}}";
+    }
+    
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const TraceFrame& frame = frames[i];
+        file << ",\n{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":" << micros(frame.start)
+             << ",\"dur\":" << static_cast<double>(frame.end - frame.start) * 1e-3
+             << ",\"args\":{\"ms\":" << static_cast<double>(frame.end - frame.start) * 1e-6 << "}}";
+        for (const TraceEvent& event : frame.events) {
+            if (event.start == 0 || event.zone >= ZONE_COUNT) continue;
+            file << ",\n{\"name\":\"" << zoneName(static_cast<Zone>(event.zone))
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread + 1
+                 << ",\"ts\":" << micros(event.start) << ",\"dur\":" << static_cast<double>(event.duration) * 1e-3 << "}";
+        }
+    }
+    file << "\n]}\n";
+    
+    if (!file) {
+        std::cerr << "Failed to write trace file: " << path << std::endl;
+        return false;
+    }
+    std::cout << "Wrote trace of " << frames.size() << " frames to " << path << std::endl;
+    return true;
+}
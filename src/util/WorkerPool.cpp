@@ -0,0 +1,69 @@
+#include "util/WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount, size_t cap)
+    : capacity(cap), active(0), stopping(false) {
+    threadCount = std::max(threadCount, 1);
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    spaceAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (capacity > 0) {
+            spaceAvailable.wait(lock, [this] { return stopping || tasks.size() < capacity; });
+        }
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkerPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return tasks.empty() && active == 0; });
+}
+
+size_t WorkerPool::queued() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.size();
+}
+
+void WorkerPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            // Drain remaining work before shutting down so no capture is lost
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            active++;
+        }
+        spaceAvailable.notify_one();
+        
+        task();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+            if (tasks.empty() && active == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+}